@@ -0,0 +1,188 @@
+#include "AnalysisScheduler.hpp"
+#include "CodeEditor.hpp"
+
+#include <QThread>
+#include <QDebug>
+
+#include <algorithm>
+#include "c_error_detector.cpp"
+
+namespace SCERSE {
+
+AnalysisScheduler::AnalysisScheduler(QObject *parent)
+    : QObject(parent)
+    , engine(std::make_unique<CErrorDetectorEngine>())
+    , focused(nullptr)
+    , running(nullptr)
+    , busy(false)
+    , clock(0)
+    , budget(size_t(256) << 20) // 256 MB
+    , engineBytes(0)
+{
+    pool.setMaxThreadCount(1);
+}
+
+AnalysisScheduler::~AnalysisScheduler()
+{
+    pool.clear();
+    pool.waitForDone(); // the engine must outlive the running job
+}
+
+void AnalysisScheduler::addDocument(DocumentSession *session)
+{
+    documents.append(session);
+    pending.append(session);
+
+    // Started from the event loop, so a tab focused right after opening goes first
+    QMetaObject::invokeMethod(this, [this]() { startNext(); }, Qt::QueuedConnection);
+}
+
+void AnalysisScheduler::removeDocument(DocumentSession *session)
+{
+    documents.removeOne(session);
+    pending.removeOne(session);
+    if (focused == session)
+        focused = nullptr;
+    if (running == session)
+        running = nullptr;
+
+    // Drop its symbols from the workspace index, in turn with the analyses
+    if (!session->filePath().isEmpty())
+    {
+        CErrorDetectorEngine *shared = engine.get();
+        std::string path = session->filePath().toStdString();
+        pool.start([shared, path]() { shared->forgetFile(path); });
+    }
+}
+
+void AnalysisScheduler::setFocused(DocumentSession *session)
+{
+    focused = session;
+    if (!session)
+        return;
+
+    session->setLastFocused(++clock);
+    if (!session->isAnalyzed())
+        requestAnalysis(session);
+}
+
+void AnalysisScheduler::requestAnalysis(DocumentSession *session)
+{
+    if (!pending.contains(session))
+        pending.append(session);
+    startNext();
+}
+
+void AnalysisScheduler::setMemoryBudget(size_t bytes)
+{
+    budget = bytes;
+    enforceBudget(nullptr);
+}
+
+size_t AnalysisScheduler::memoryUsage() const
+{
+    return engineBytes + documentBytes();
+}
+
+size_t AnalysisScheduler::documentBytes() const
+{
+    size_t bytes = 0;
+    for (const DocumentSession *session : documents)
+        bytes += session->cachedBytes();
+    return bytes;
+}
+
+void AnalysisScheduler::startNext()
+{
+    DocumentSession *next = nullptr;
+    while (!busy && !pending.isEmpty() && !next)
+    {
+        // The focused document first, then the most recently viewed
+        next = pending.contains(focused)
+                   ? focused
+                   : *std::max_element(pending.begin(), pending.end(),
+                                       [](const DocumentSession *a, const DocumentSession *b)
+                                       { return a->lastFocused() < b->lastFocused(); });
+        pending.removeOne(next);
+        if (next->isAnalyzed() || next->isLoading()) // a loaded document is requested again
+            next = nullptr;
+    }
+    if (!next)
+        return;
+
+    running = next;
+    busy = true;
+
+    // The text is copied here; the worker never touches the editor
+    std::string code = next->editor()->toPlainText().toStdString();
+    std::string path = next->filePath().toStdString();
+    quint64 revision = next->revision();
+    bool background = next != focused;
+    size_t documentUse = documentBytes();
+    size_t cacheLimit = budget > documentUse ? budget - documentUse : 0;
+    CErrorDetectorEngine *shared = engine.get();
+
+    qDebug() << "Analyzing" << next->displayName() << (background ? "(background)" : "");
+
+    pool.start([this, shared, code = std::move(code), path, revision, background, cacheLimit]()
+               {
+        QThread::currentThread()->setPriority(background ? QThread::LowPriority : QThread::NormalPriority);
+
+        DocumentDiagnostics diagnostics;
+        if (!code.empty())
+        {
+            AnalysisResult result = shared->analyzeCode(code, path);
+            diagnostics.lexicalErrors = std::move(result.lexicalErrors);
+            diagnostics.syntaxErrors = std::move(result.syntaxErrors);
+        }
+        shared->trimCache(cacheLimit);
+        size_t cacheBytes = shared->cachedBytes();
+
+        QMetaObject::invokeMethod(
+            this, [this, revision, diagnostics, cacheBytes]() mutable
+            { jobFinished(revision, std::move(diagnostics), cacheBytes); },
+            Qt::QueuedConnection); });
+}
+
+void AnalysisScheduler::jobFinished(quint64 revision, DocumentDiagnostics diagnostics, size_t cacheBytes)
+{
+    DocumentSession *session = running;
+    running = nullptr;
+    busy = false;
+    engineBytes = cacheBytes;
+
+    if (session)
+    {
+        session->setDiagnostics(std::move(diagnostics), revision);
+        enforceBudget(session);
+        emit analysisFinished(session);
+    }
+    startNext();
+}
+
+// Evicts the diagnostics of tabs not on screen, least recently viewed first;
+// the engine's header cache is trimmed to what remains by the next analysis
+void AnalysisScheduler::enforceBudget(DocumentSession *keep)
+{
+    size_t used = memoryUsage();
+    if (used <= budget)
+        return;
+
+    QList<DocumentSession *> idle;
+    for (DocumentSession *session : documents)
+        if (session != focused && session != keep && session->hasDiagnostics())
+            idle.append(session);
+    std::sort(idle.begin(), idle.end(), [](const DocumentSession *a, const DocumentSession *b)
+              { return a->lastFocused() < b->lastFocused(); });
+
+    for (DocumentSession *session : idle)
+    {
+        if (used <= budget)
+            break;
+        used -= session->cachedBytes();
+        session->evict();
+        qDebug() << "Evicted diagnostics of" << session->displayName();
+    }
+}
+
+} // namespace SCERSE
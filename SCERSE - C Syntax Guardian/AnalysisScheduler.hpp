@@ -0,0 +1,63 @@
+// ============================================================================
+// FILE 10: AnalysisScheduler.hpp
+// ============================================================================
+
+#pragma once
+
+#include "DocumentSession.hpp"
+
+#include <QObject>
+#include <QList>
+#include <QThreadPool>
+
+#include <memory>
+
+class CErrorDetectorEngine;
+
+namespace SCERSE {
+
+// Analyzes every open document on one worker thread with one shared engine,
+// so headers are lexed once for all tabs and twenty tabs use one core, not
+// twenty (the engine's string interner is process-wide and unsynchronized
+// anyway). The focused document is analyzed first; background tabs wait
+// and run at low thread priority. Cached diagnostics of idle tabs and the
+// engine's lexed headers share one memory budget, least recently viewed
+// tabs being evicted first.
+class AnalysisScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    explicit AnalysisScheduler(QObject *parent = nullptr);
+    ~AnalysisScheduler();
+
+    void addDocument(DocumentSession *session);    // queued at background priority
+    void removeDocument(DocumentSession *session); // a running analysis of it is discarded
+    void setFocused(DocumentSession *session);     // analyzed first; re-analyzed if evicted
+    void requestAnalysis(DocumentSession *session);
+
+    void setMemoryBudget(size_t bytes);
+    size_t memoryBudget() const { return budget; }
+    size_t memoryUsage() const;
+
+signals:
+    void analysisFinished(SCERSE::DocumentSession *session);
+
+private:
+    void startNext();
+    void jobFinished(quint64 revision, DocumentDiagnostics diagnostics, size_t cacheBytes);
+    void enforceBudget(DocumentSession *keep);
+    size_t documentBytes() const;
+
+    QThreadPool pool;
+    std::unique_ptr<CErrorDetectorEngine> engine; // touched by the worker thread only
+    QList<DocumentSession *> documents;
+    QList<DocumentSession *> pending;             // waiting for an analysis
+    DocumentSession *focused;
+    DocumentSession *running;                     // nullptr too if its tab closed meanwhile
+    bool busy;
+    quint64 clock;                                // ticks on every focus change
+    size_t budget;
+    size_t engineBytes;                           // engine cache after the last analysis
+};
+
+} // namespace SCERSE
@@ -0,0 +1,51 @@
+#include "DocumentSession.hpp"
+
+#include <QFileInfo>
+
+namespace SCERSE {
+
+static size_t stringBytes(const std::string &s)
+{
+    return sizeof(std::string) + (s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0);
+}
+
+DocumentSession::DocumentSession(CodeEditor *editor, quint64 id)
+    : codeEditor(editor)
+    , sessionId(id)
+    , modified(false)
+    , loading(false)
+    , currentRevision(1)
+    , analyzedRevision(0)
+    , cached(false)
+    , bytes(0)
+    , focusTick(0)
+{
+}
+
+QString DocumentSession::displayName() const
+{
+    return path.isEmpty() ? QString("Untitled") : QFileInfo(path).fileName();
+}
+
+void DocumentSession::setDiagnostics(DocumentDiagnostics diagnostics, quint64 revision)
+{
+    results = std::move(diagnostics);
+    analyzedRevision = revision;
+    cached = true;
+
+    bytes = 0;
+    for (const auto &err : results.lexicalErrors)
+        bytes += stringBytes(err);
+    for (const auto &[err, sug] : results.syntaxErrors)
+        bytes += stringBytes(err) + stringBytes(sug);
+}
+
+void DocumentSession::evict()
+{
+    results = DocumentDiagnostics();
+    cached = false;
+    analyzedRevision = 0;
+    bytes = 0;
+}
+
+} // namespace SCERSE
@@ -0,0 +1,75 @@
+// ============================================================================
+// FILE 9: DocumentSession.hpp
+// ============================================================================
+
+#pragma once
+
+#include <QString>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SCERSE {
+
+class CodeEditor;
+
+// Findings of one analysis, as the engine reports them
+struct DocumentDiagnostics {
+    std::vector<std::string> lexicalErrors;
+    std::vector<std::pair<std::string, std::string>> syntaxErrors; // (error, suggestion)
+};
+
+// One open tab: its editor, file and the last analysis of its text
+class DocumentSession {
+public:
+    DocumentSession(CodeEditor *editor, quint64 id);
+
+    CodeEditor *editor() const { return codeEditor; }
+
+    // Never reused, unlike the session's address; queued file I/O results carry it
+    quint64 id() const { return sessionId; }
+
+    const QString &filePath() const { return path; }
+    void setFilePath(const QString &filePath) { path = filePath; }
+    QString displayName() const; // file name, or "Untitled"
+
+    bool isModified() const { return modified; }
+    void setModified(bool on) { modified = on; }
+
+    // While the file streams in the text is incomplete: not analyzed, not saved
+    bool isLoading() const { return loading; }
+    void setLoading(bool on) { loading = on; }
+
+    // Every edit, or a new path, starts a revision; diagnostics belong to the one analyzed
+    quint64 revision() const { return currentRevision; }
+    void touch() { currentRevision++; }
+
+    bool hasDiagnostics() const { return cached; }
+    bool isAnalyzed() const { return cached && analyzedRevision == currentRevision; }
+    const DocumentDiagnostics &diagnostics() const { return results; }
+    void setDiagnostics(DocumentDiagnostics diagnostics, quint64 revision);
+
+    // Memory the cached diagnostics hold; evict() frees it until the next analysis
+    size_t cachedBytes() const { return bytes; }
+    void evict();
+
+    // Scheduler clock at the last time the tab was shown, for LRU eviction
+    quint64 lastFocused() const { return focusTick; }
+    void setLastFocused(quint64 tick) { focusTick = tick; }
+
+private:
+    CodeEditor *codeEditor;
+    quint64 sessionId;
+    QString path;
+    bool modified;
+    bool loading;
+    quint64 currentRevision;
+    quint64 analyzedRevision;
+    bool cached;
+    DocumentDiagnostics results;
+    size_t bytes;
+    quint64 focusTick;
+};
+
+} // namespace SCERSE
@@ -0,0 +1,121 @@
+#include "FileIO.hpp"
+#include "source_encoding.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QDebug>
+
+namespace SCERSE {
+
+FileLoader::FileLoader(const QString &filePath)
+    : path(filePath)
+    , cancelled(false)
+{
+    connect(this, &FileLoader::finished, this, &QObject::deleteLater);
+}
+
+void FileLoader::start(QThreadPool *pool)
+{
+    pool->start([this]() { run(); });
+}
+
+// Worker thread; nothing may touch the loader after finished() is emitted
+void FileLoader::run()
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        emit finished(false, QString(), file.errorString());
+        return;
+    }
+
+    qDebug() << "Loading" << path << file.size() << "bytes";
+
+    const qint64 total = file.size();
+    qint64 done = 0;
+    SourceDecoder decoder; // keeps a sequence split across chunks
+    std::string utf8;
+    bool pendingCR = false; // chunk ended between '\r' and '\n'
+
+    while (!cancelled)
+    {
+        QByteArray bytes = file.read(CHUNK_BYTES);
+        if (bytes.isEmpty())
+            break;
+        done += bytes.size();
+
+        utf8.clear();
+        decoder.decode(bytes.constData(), size_t(bytes.size()), utf8);
+        if (decoder.encoding() == SourceEncoding::Binary)
+        {
+            emit finished(false, encodingName(decoder.encoding()), "Not a text file");
+            return;
+        }
+        QString text = QString::fromUtf8(utf8.data(), qsizetype(utf8.size()));
+        if (pendingCR)
+            text.prepend(QLatin1Char('\r'));
+        pendingCR = text.endsWith(QLatin1Char('\r'));
+        if (pendingCR)
+            text.chop(1);
+        text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+
+        emit chunkLoaded(text);
+        emit progress(done, total);
+    }
+    utf8.clear();
+    decoder.finish(utf8);
+    if (decoder.encoding() == SourceEncoding::Binary) // shorter than a byte order mark
+    {
+        emit finished(false, encodingName(decoder.encoding()), "Not a text file");
+        return;
+    }
+    QString tail = QString::fromUtf8(utf8.data(), qsizetype(utf8.size()));
+    if (pendingCR)
+        tail.prepend(QLatin1Char('\r'));
+    tail.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    if (!tail.isEmpty() && !cancelled)
+        emit chunkLoaded(tail);
+
+    QString encoding = encodingName(decoder.encoding());
+    if (cancelled)
+        emit finished(false, encoding, "Cancelled");
+    else if (file.error() != QFileDevice::NoError)
+        emit finished(false, encoding, file.errorString());
+    else
+        emit finished(true, encoding, QString());
+}
+
+FileSaver::FileSaver(const QString &filePath, const QString &text)
+    : path(filePath)
+    , contents(text)
+{
+    connect(this, &FileSaver::finished, this, &QObject::deleteLater);
+}
+
+void FileSaver::start(QThreadPool *pool)
+{
+    pool->start([this]() { run(); });
+}
+
+// Worker thread; the old file stays untouched unless every byte was written
+void FileSaver::run()
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        emit finished(false, file.errorString());
+        return;
+    }
+
+    QByteArray bytes = contents.toUtf8();
+    contents.clear();
+    if (file.write(bytes) != bytes.size() || !file.commit())
+    {
+        emit finished(false, file.errorString());
+        return;
+    }
+    emit finished(true, QString());
+}
+
+} // namespace SCERSE
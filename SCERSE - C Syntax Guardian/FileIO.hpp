@@ -0,0 +1,68 @@
+// ============================================================================
+// FILE 11: FileIO.hpp
+// ============================================================================
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+class QThreadPool;
+QT_END_NAMESPACE
+
+namespace SCERSE {
+
+// Reads a file on a worker thread and hands it over in chunks, decoded to
+// text with CRLF turned into '\n', so the first screen shows while the rest
+// is still on its way. The encoding is detected as the analyzer does (see
+// source_encoding.h); binary files fail after the first chunk. Signals are
+// emitted from the worker and arrive queued; the loader deletes itself after
+// finished().
+class FileLoader : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 CHUNK_BYTES = 256 * 1024;
+
+    explicit FileLoader(const QString &filePath);
+
+    void start(QThreadPool *pool);
+    void cancel() { cancelled = true; } // finished(false, ...) still follows
+
+signals:
+    void chunkLoaded(const QString &text);
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    void finished(bool ok, const QString &encoding, const QString &error); // encoding the file was in
+
+private:
+    void run();
+
+    QString path;
+    std::atomic<bool> cancelled;
+};
+
+// Writes text to a file on a worker thread, atomically: QSaveFile writes a
+// temporary file and renames it over the old one only once it is complete.
+// Deletes itself after finished().
+class FileSaver : public QObject {
+    Q_OBJECT
+
+public:
+    FileSaver(const QString &filePath, const QString &text);
+
+    void start(QThreadPool *pool);
+
+signals:
+    void finished(bool ok, const QString &error);
+
+private:
+    void run();
+
+    QString path;
+    QString contents;
+};
+
+} // namespace SCERSE
@@ -1,6 +1,9 @@
 #include "MainWindow.hpp"
 #include "CodeEditor.hpp"
 #include "SyntaxHighlighter.hpp"
+#include "DocumentSession.hpp"
+#include "AnalysisScheduler.hpp"
+#include "FileIO.hpp"
 
 #include <QWidget>
 #include <QVBoxLayout>
@@ -10,17 +13,17 @@
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QDebug>
-#include <QTextStream>
-#include <QFile>
 #include <QTableWidgetItem>
 #include <QHeaderView>
-#include "c_error_detector.cpp"
+#include <QRegularExpression>
+#include <QTextDocument>
+#include <QTextCursor>
 
 namespace SCERSE
 {
 
     MainWindow::MainWindow(QWidget *parent)
-        : QMainWindow(parent), codeEditor(nullptr), errorTable(nullptr), suggestionsList(nullptr), mainSplitter(nullptr), analyzeTimer(nullptr), statusLabel(nullptr), lineColLabel(nullptr), errorCountLabel(nullptr), isModified(false)
+        : QMainWindow(parent), tabs(nullptr), errorTable(nullptr), suggestionsList(nullptr), mainSplitter(nullptr), analyzeTimer(nullptr), shownSession(nullptr), scheduler(nullptr), nextSessionId(0), fileIO(nullptr), statusLabel(nullptr), lineColLabel(nullptr), errorCountLabel(nullptr), progressBar(nullptr)
     {
         qDebug() << "=== MainWindow Constructor Starting ===";
 
@@ -32,7 +35,10 @@ namespace SCERSE
         mainSplitter = new QSplitter(Qt::Vertical, central);
 
         // Create components
-        codeEditor = new CodeEditor(mainSplitter);
+        tabs = new QTabWidget(mainSplitter);
+        tabs->setTabsClosable(true);
+        tabs->setMovable(true);
+        tabs->setDocumentMode(true);
         errorTable = new QTableWidget(mainSplitter);
         suggestionsList = new QListWidget(mainSplitter);
 
@@ -46,7 +52,7 @@ namespace SCERSE
         suggestionsList->setMaximumHeight(150);
 
         // Add widgets to splitter
-        mainSplitter->addWidget(codeEditor);
+        mainSplitter->addWidget(tabs);
         mainSplitter->addWidget(errorTable);
         mainSplitter->addWidget(suggestionsList);
 
@@ -74,6 +80,11 @@ namespace SCERSE
         analyzeTimer->setSingleShot(true);
         analyzeTimer->setInterval(500); // 500ms debounce
 
+        scheduler = new AnalysisScheduler(this);
+
+        fileIO = new QThreadPool(this);
+        fileIO->setMaxThreadCount(1);
+
         // ===== Connections =====
         setupConnections();
 
@@ -84,9 +95,7 @@ namespace SCERSE
         resize(1400, 900);
 
         // Load sample code
-        if (codeEditor)
-        {
-            codeEditor->setPlainText(
+        addDocument(
                 "/*DISCLAIMER:\n"
                 "S.C.E.R.S.E. cannot detect preprocessor errors, only their base syntax is checked and are skipped from analysis\n"
                 "S.C.E.R.S.E. is assuming standard library usage (std::) and does not check for logical errors\n\n"
@@ -98,8 +107,8 @@ namespace SCERSE
                 "    \n"
                 "    printf(\"Sum: %d\\n\", x + y);\n"
                 "    return 0;\n"
-                "}\n");
-        }
+                "}\n",
+                QString());
 
         statusBar()->showMessage("Ready");
         qDebug() << "=== MainWindow Constructor Complete ===";
@@ -108,6 +117,21 @@ namespace SCERSE
     MainWindow::~MainWindow()
     {
         qDebug() << "MainWindow destructor";
+
+        // Tabs emit currentChanged while they are torn down
+        tabs->disconnect(this);
+
+        // Pending saves still complete; loads are abandoned
+        for (const QPointer<FileLoader> &loader : loaders)
+        {
+            if (loader)
+                loader->cancel();
+        }
+        fileIO->waitForDone();
+
+        // Waits for a running analysis before the sessions go away
+        delete scheduler;
+        qDeleteAll(sessions);
     }
 
     void MainWindow::setupErrorTable()
@@ -149,6 +173,11 @@ namespace SCERSE
         connect(saveAction, &QAction::triggered, this, &MainWindow::saveFile);
         fileMenu->addAction(saveAction);
 
+        closeAction = new QAction("&Close", this);
+        closeAction->setShortcut(QKeySequence::Close);
+        connect(closeAction, &QAction::triggered, this, &MainWindow::closeFile);
+        fileMenu->addAction(closeAction);
+
         fileMenu->addSeparator();
 
         exitAction = new QAction("E&xit", this);
@@ -187,38 +216,210 @@ namespace SCERSE
 
         lineColLabel = new QLabel("Line: 1, Col: 1", this);
         statusBar()->addPermanentWidget(lineColLabel);
+
+        // Shown while a file loads
+        progressBar = new QProgressBar(this);
+        progressBar->setRange(0, 100);
+        progressBar->setMaximumWidth(150);
+        progressBar->hide();
+        statusBar()->addPermanentWidget(progressBar);
     }
 
     void MainWindow::setupConnections()
     {
         qDebug() << "Setting up connections";
 
-        // Text changes trigger debounced analysis
-        // DO NOT CONNECT TO cursorPositionChanged during text change!
-        connect(codeEditor, &QPlainTextEdit::textChanged,
-                this, &MainWindow::onEditorTextChanged);
+        // Editors are connected as their tabs open (addDocument)
+        connect(tabs, &QTabWidget::currentChanged,
+                this, &MainWindow::onCurrentTabChanged);
+        connect(tabs, &QTabWidget::tabCloseRequested,
+                this, &MainWindow::onTabCloseRequested);
 
         // Timer triggers analysis pipeline
         connect(analyzeTimer, &QTimer::timeout,
                 this, &MainWindow::runAnalyzerPipeline);
 
+        // Finished analyses come back on the GUI thread
+        connect(scheduler, &AnalysisScheduler::analysisFinished,
+                this, &MainWindow::onAnalysisFinished);
+
         // Error table clicks
         connect(errorTable, QOverload<int, int>::of(&QTableWidget::cellClicked),
                 this, &MainWindow::onErrorTableClicked);
+    }
+
+    // fromDisk: text is ignored and the file streams in from filePath
+    DocumentSession *MainWindow::addDocument(const QString &text, const QString &filePath, bool fromDisk)
+    {
+        CodeEditor *editor = new CodeEditor(tabs);
+        DocumentSession *session = new DocumentSession(editor, ++nextSessionId);
+        session->setFilePath(filePath);
+        if (fromDisk)
+        {
+            session->setLoading(true);
+            editor->setReadOnly(true);
+            editor->setUndoRedoEnabled(false); // loading is not an edit to undo
+        }
+        else
+        {
+            editor->setPlainText(text);
+        }
+        sessions.append(session);
+        scheduler->addDocument(session);
+
+        // Text changes trigger debounced analysis
+        // DO NOT CONNECT TO cursorPositionChanged during text change!
+        connect(editor, &QPlainTextEdit::textChanged,
+                this, &MainWindow::onEditorTextChanged);
 
         // Cursor changes update status bar (AFTER text stabilizes)
-        connect(codeEditor, &QPlainTextEdit::cursorPositionChanged,
+        connect(editor, &QPlainTextEdit::cursorPositionChanged,
                 this, &MainWindow::updateStatusBar);
+
+        int index = tabs->addTab(editor, session->displayName());
+        tabs->setTabToolTip(index, filePath);
+        tabs->setCurrentIndex(index);
+
+        if (fromDisk)
+        {
+            quint64 id = session->id();
+            FileLoader *loader = new FileLoader(filePath);
+            loaders.insert(id, loader);
+            connect(loader, &FileLoader::chunkLoaded, this, [this, id](const QString &chunk)
+                    { onChunkLoaded(id, chunk); });
+            connect(loader, &FileLoader::progress, this, [this, id](qint64 bytesRead, qint64 totalBytes)
+                    { onLoadProgress(id, bytesRead, totalBytes); });
+            connect(loader, &FileLoader::finished, this,
+                    [this, id](bool ok, const QString &encoding, const QString &error)
+                    { onLoadFinished(id, ok, encoding, error); });
+            loader->start(fileIO);
+        }
+        return session;
+    }
+
+    DocumentSession *MainWindow::sessionById(quint64 id) const
+    {
+        for (DocumentSession *session : sessions)
+        {
+            if (session->id() == id)
+                return session;
+        }
+        return nullptr;
+    }
+
+    void MainWindow::onChunkLoaded(quint64 id, const QString &text)
+    {
+        DocumentSession *session = sessionById(id);
+        if (!session)
+            return;
+
+        CodeEditor *editor = session->editor();
+        bool first = editor->document()->isEmpty();
+        QTextCursor cursor(editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(text);
+
+        // Keep the view on the first screen while the rest is appended
+        if (first)
+            editor->moveCursor(QTextCursor::Start);
+    }
+
+    void MainWindow::onLoadProgress(quint64 id, qint64 bytesRead, qint64 totalBytes)
+    {
+        DocumentSession *session = sessionById(id);
+        if (!session || session != currentSession())
+            return;
+
+        int percent = totalBytes > 0 ? int(bytesRead * 100 / totalBytes) : 100;
+        progressBar->setValue(percent);
+        progressBar->show();
+        statusBar()->showMessage(QString("Loading %1... %2%").arg(session->displayName()).arg(percent));
+    }
+
+    void MainWindow::onLoadFinished(quint64 id, bool ok, const QString &encoding, const QString &error)
+    {
+        loaders.remove(id);
+        if (loaders.isEmpty())
+            progressBar->hide();
+
+        DocumentSession *session = sessionById(id);
+        if (!session)
+            return;
+
+        CodeEditor *editor = session->editor();
+        session->setLoading(false);
+        editor->setReadOnly(false);
+        editor->setUndoRedoEnabled(true);
+
+        if (!ok)
+        {
+            QMessageBox::warning(this, "Error", "Could not open file: " + session->filePath() + "\n" + error);
+            closeDocument(tabs->indexOf(editor));
+            return;
+        }
+
+        // The text is complete: analyze it
+        session->touch();
+        scheduler->requestAnalysis(session);
+        // Saving writes UTF-8 whatever the file was in
+        QString converted = encoding == "UTF-8" ? QString() : " (converted from " + encoding + " to UTF-8)";
+        if (session == currentSession())
+            statusBar()->showMessage("Opened: " + session->filePath() + converted);
+
+        qDebug() << "File opened:" << session->filePath() << encoding;
+    }
+
+    DocumentSession *MainWindow::sessionFor(const QWidget *editor) const
+    {
+        for (DocumentSession *session : sessions)
+        {
+            if (session->editor() == editor)
+                return session;
+        }
+        return nullptr;
+    }
+
+    DocumentSession *MainWindow::currentSession() const
+    {
+        return tabs ? sessionFor(tabs->currentWidget()) : nullptr;
+    }
+
+    CodeEditor *MainWindow::currentEditor() const
+    {
+        DocumentSession *session = currentSession();
+        return session ? session->editor() : nullptr;
+    }
+
+    void MainWindow::updateTitles(DocumentSession *session)
+    {
+        int index = tabs->indexOf(session->editor());
+        if (index >= 0)
+        {
+            tabs->setTabText(index, session->displayName() + (session->isModified() ? " *" : ""));
+            tabs->setTabToolTip(index, session->filePath());
+        }
+
+        if (session != currentSession())
+            return;
+        if (session->filePath().isEmpty())
+            setWindowTitle("SCERSE - C Syntax Guardian");
+        else
+            setWindowTitle("SCERSE - " + session->filePath() + (session->isModified() ? " *" : ""));
     }
 
     void MainWindow::onEditorTextChanged()
     {
         qDebug() << "Editor text changed - debouncing...";
 
-        isModified = true;
-        if (!currentFilePath.isEmpty())
+        DocumentSession *session = sessionFor(qobject_cast<QWidget *>(sender()));
+        if (!session || session->isLoading())
+            return;
+
+        session->touch();
+        if (!session->isModified())
         {
-            setWindowTitle("SCERSE - " + currentFilePath + " *");
+            session->setModified(true);
+            updateTitles(session);
         }
 
         // Restart timer on text change
@@ -231,27 +432,32 @@ namespace SCERSE
     {
         qDebug() << "=== Starting Analysis Pipeline ===";
 
-        if (!codeEditor)
+        DocumentSession *session = currentSession();
+        if (!session)
         {
-            qDebug() << "ERROR: codeEditor is null";
+            qDebug() << "ERROR: no document open";
             return;
         }
 
-        QString code = codeEditor->toPlainText();
+        // ===== CALL YOUR C ERROR DETECTOR (on the scheduler's worker thread) =====
+        scheduler->requestAnalysis(session);
+    }
+
+    void MainWindow::onAnalysisFinished(DocumentSession *session)
+    {
+        // Background tabs keep their results until they are shown
+        if (session != currentSession())
+            return;
 
-        if (code.isEmpty())
+        if (session->editor()->document()->isEmpty())
         {
             clearAll();
             statusBar()->showMessage("Ready - No code to analyze");
             return;
         }
 
-        // ===== CALL YOUR C ERROR DETECTOR =====
-        CErrorDetectorEngine engine;
-        AnalysisResult result = engine.analyzeCode(code.toStdString());
-
-        std::vector<std::string> lexicalErrors = result.lexicalErrors;
-        std::vector<std::pair<std::string, std::string>> syntaxErrors = result.syntaxErrors;
+        const std::vector<std::string> &lexicalErrors = session->diagnostics().lexicalErrors;
+        const std::vector<std::pair<std::string, std::string>> &syntaxErrors = session->diagnostics().syntaxErrors;
 
         // Display filtered results
         displayErrors(lexicalErrors, syntaxErrors);
@@ -281,6 +487,96 @@ namespace SCERSE
         qDebug() << "=== Analysis Complete - Errors:" << totalErrors << "===";
     }
 
+    void MainWindow::onCurrentTabChanged(int index)
+    {
+        qDebug() << "Switched to tab" << index;
+
+        // An edit still waiting for the debounce is analyzed in the background
+        if (analyzeTimer->isActive() && sessions.contains(shownSession))
+        {
+            analyzeTimer->stop();
+            scheduler->requestAnalysis(shownSession);
+        }
+
+        shownSession = currentSession();
+        scheduler->setFocused(shownSession);
+        if (!shownSession)
+            return;
+
+        updateTitles(shownSession);
+        updateStatusBar();
+        if (shownSession->isLoading())
+        {
+            clearAll();
+            statusBar()->showMessage("Loading " + shownSession->displayName() + "...");
+        }
+        else if (shownSession->hasDiagnostics())
+        {
+            onAnalysisFinished(shownSession);
+        }
+        else
+        {
+            // Evicted or never analyzed: setFocused() queued it first
+            clearAll();
+            statusBar()->showMessage("Analyzing...");
+        }
+    }
+
+    void MainWindow::onTabCloseRequested(int index)
+    {
+        closeDocument(index);
+    }
+
+    void MainWindow::closeFile()
+    {
+        closeDocument(tabs->currentIndex());
+    }
+
+    bool MainWindow::closeDocument(int index)
+    {
+        DocumentSession *session = sessionFor(tabs->widget(index));
+        if (!session)
+            return false;
+
+        qDebug() << "Closing" << session->displayName();
+
+        if (session->isModified())
+        {
+            tabs->setCurrentIndex(index);
+            QMessageBox::StandardButton ret = QMessageBox::warning(this,
+                                                                   "SCERSE",
+                                                                   "The document has been modified.\nDo you want to save changes?",
+                                                                   QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
+
+            if (ret == QMessageBox::Cancel)
+                return false;
+            if (ret == QMessageBox::Save)
+            {
+                saveDocument(session, true); // the tab closes once the file is written
+                return false;
+            }
+        }
+
+        if (QPointer<FileLoader> loader = loaders.value(session->id()))
+            loader->cancel();
+
+        if (session == shownSession)
+        {
+            analyzeTimer->stop();
+            shownSession = nullptr;
+        }
+        scheduler->removeDocument(session);
+        sessions.removeOne(session);
+        tabs->removeTab(index);
+        session->editor()->deleteLater();
+        delete session;
+
+        // Always keep one document open
+        if (sessions.isEmpty())
+            addDocument(QString(), QString());
+        return true;
+    }
+
     void MainWindow::displayErrors(const std::vector<std::string> &lexErrors,
                                    const std::vector<std::pair<std::string, std::string>> &syntaxErrors)
     {
@@ -396,7 +692,8 @@ namespace SCERSE
 
         errorTable->setRowCount(0);
         suggestionsList->clear();
-        codeEditor->clearErrorHighlighting();
+        if (CodeEditor *codeEditor = currentEditor())
+            codeEditor->clearErrorHighlighting();
         errorCountLabel->setText("Errors: 0");
     }
 
@@ -404,6 +701,7 @@ namespace SCERSE
     {
         qDebug() << "Highlighting error line:" << lineNumber;
 
+        CodeEditor *codeEditor = currentEditor();
         if (codeEditor)
         {
             codeEditor->highlightErrorLine(lineNumber);
@@ -435,6 +733,7 @@ namespace SCERSE
 
     void MainWindow::updateStatusBar()
     {
+        CodeEditor *codeEditor = currentEditor();
         if (!codeEditor)
             return;
 
@@ -448,24 +747,7 @@ namespace SCERSE
     {
         qDebug() << "New file action";
 
-        if (isModified)
-        {
-            QMessageBox::StandardButton ret = QMessageBox::warning(this,
-                                                                   "SCERSE",
-                                                                   "The document has been modified.\nDo you want to save changes?",
-                                                                   QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
-
-            if (ret == QMessageBox::Cancel)
-                return;
-            if (ret == QMessageBox::Save)
-                saveFile();
-        }
-
-        codeEditor->clear();
-        currentFilePath.clear();
-        isModified = false;
-        setWindowTitle("SCERSE - C Code Analyzer");
-        clearAll();
+        addDocument(QString(), QString());
         statusBar()->showMessage("New file");
     }
 
@@ -479,54 +761,91 @@ namespace SCERSE
         if (fileName.isEmpty())
             return;
 
-        QFile file(fileName);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        // Already open: just switch to its tab
+        for (DocumentSession *session : sessions)
         {
-            QMessageBox::warning(this, "Error", "Could not open file: " + fileName);
-            return;
+            if (session->filePath() == fileName)
+            {
+                tabs->setCurrentWidget(session->editor());
+                return;
+            }
         }
 
-        QTextStream in(&file);
-        codeEditor->setPlainText(in.readAll());
-        file.close();
-
-        currentFilePath = fileName;
-        isModified = false;
-        setWindowTitle("SCERSE - " + fileName);
-        statusBar()->showMessage("Opened: " + fileName);
-
-        qDebug() << "File opened:" << fileName;
+        // Streams in on the file I/O thread; see onChunkLoaded()
+        addDocument(QString(), fileName, true);
+        statusBar()->showMessage("Loading " + fileName + "...");
     }
 
     void MainWindow::saveFile()
     {
         qDebug() << "Save file action";
 
-        if (currentFilePath.isEmpty())
+        if (DocumentSession *session = currentSession())
+            saveDocument(session);
+    }
+
+    // Starts a background save; false if there is nothing to start
+    bool MainWindow::saveDocument(DocumentSession *session, bool closeWhenSaved)
+    {
+        if (session->isLoading())
         {
-            currentFilePath = QFileDialog::getSaveFileName(this,
-                                                           "Save C File", "", "C Files (*.c);;All Files (*)");
+            statusBar()->showMessage("Still loading: " + session->displayName());
+            return false;
         }
 
-        if (currentFilePath.isEmpty())
-            return;
+        QString filePath = session->filePath();
+        if (filePath.isEmpty())
+        {
+            filePath = QFileDialog::getSaveFileName(this,
+                                                    "Save C File", "", "C Files (*.c);;All Files (*)");
+        }
 
-        QFile file(currentFilePath);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        if (filePath.isEmpty())
+            return false;
+
+        // The text is copied now; edits made while it is written keep the tab modified
+        quint64 id = session->id();
+        quint64 revision = session->revision();
+        FileSaver *saver = new FileSaver(filePath, session->editor()->toPlainText());
+        connect(saver, &FileSaver::finished, this,
+                [this, id, filePath, revision, closeWhenSaved](bool ok, const QString &error)
+                { onSaveFinished(id, filePath, revision, closeWhenSaved, ok, error); });
+        saver->start(fileIO);
+
+        statusBar()->showMessage("Saving: " + filePath);
+        return true;
+    }
+
+    void MainWindow::onSaveFinished(quint64 id, const QString &filePath, quint64 revision, bool closeWhenSaved,
+                                    bool ok, const QString &error)
+    {
+        if (!ok)
         {
-            QMessageBox::warning(this, "Error", "Could not save file: " + currentFilePath);
+            QMessageBox::warning(this, "Error", "Could not save file: " + filePath + "\n" + error);
             return;
         }
 
-        QTextStream out(&file);
-        out << codeEditor->toPlainText();
-        file.close();
+        statusBar()->showMessage("Saved: " + filePath);
+        qDebug() << "File saved:" << filePath;
 
-        isModified = false;
-        setWindowTitle("SCERSE - " + currentFilePath);
-        statusBar()->showMessage("Saved: " + currentFilePath);
+        DocumentSession *session = sessionById(id);
+        if (!session)
+            return;
+
+        if (session->revision() == revision)
+            session->setModified(false);
+
+        // Quoted #includes resolve relative to the new path
+        if (filePath != session->filePath())
+        {
+            session->setFilePath(filePath);
+            session->touch();
+            scheduler->requestAnalysis(session);
+        }
+        updateTitles(session);
 
-        qDebug() << "File saved:" << currentFilePath;
+        if (closeWhenSaved && !session->isModified())
+            closeDocument(tabs->indexOf(session->editor()));
     }
 
 } // namespace SCERSE
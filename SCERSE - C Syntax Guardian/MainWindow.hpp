@@ -12,12 +12,21 @@
 #include <QAction>
 #include <QMenu>
 #include <QTableWidget>
+#include <QTabWidget>
+#include <QList>
+#include <QHash>
+#include <QPointer>
+#include <QProgressBar>
+#include <QThreadPool>
 
 
 namespace SCERSE {
 
 class CodeEditor;
 class SyntaxHighlighter;
+class DocumentSession;
+class AnalysisScheduler;
+class FileLoader;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -29,27 +38,42 @@ public:
 private slots:
     void onEditorTextChanged();
     void runAnalyzerPipeline();
+    void onAnalysisFinished(SCERSE::DocumentSession *session);
+    void onCurrentTabChanged(int index);
+    void onTabCloseRequested(int index);
     void highlightErrorLine(int lineNumber);
     void onErrorTableClicked(int row, int column);
     void updateStatusBar();
     void openFile();
     void saveFile();
     void newFile();
+    void closeFile();
 
 private:
     // UI Components
-    CodeEditor *codeEditor;
+    QTabWidget *tabs;
     QTableWidget *errorTable;
     QListWidget *suggestionsList;
     QSplitter *mainSplitter;
     
-    // Timer for debounced analysis
+    // Timer for debounced analysis of the current tab
     QTimer *analyzeTimer;
+
+    // One session per tab; all analyses go through the scheduler
+    QList<DocumentSession *> sessions;
+    DocumentSession *shownSession;
+    AnalysisScheduler *scheduler;
+    quint64 nextSessionId;
+
+    // Opens and saves run here, one at a time and in order
+    QThreadPool *fileIO;
+    QHash<quint64, QPointer<FileLoader>> loaders; // by session id, while loading
     
     // Status bar
     QLabel *statusLabel;
     QLabel *lineColLabel;
     QLabel *errorCountLabel;
+    QProgressBar *progressBar;
     
     // Menus & Actions
     QMenu *fileMenu;
@@ -58,12 +82,9 @@ private:
     QAction *newAction;
     QAction *openAction;
     QAction *saveAction;
+    QAction *closeAction;
     QAction *exitAction;
     
-    // File path
-    QString currentFilePath;
-    bool isModified;
-    
     // Helper methods
     void createMenus();
     void createStatusBar();
@@ -72,6 +93,19 @@ private:
     void displayErrors(const std::vector<std::string> &lexErrors,
                       const std::vector<std::pair<std::string, std::string>> &syntaxErrors);
     void clearAll();
+    DocumentSession *addDocument(const QString &text, const QString &filePath, bool fromDisk = false);
+    DocumentSession *currentSession() const;
+    DocumentSession *sessionFor(const QWidget *editor) const;
+    DocumentSession *sessionById(quint64 id) const;
+    CodeEditor *currentEditor() const;
+    bool closeDocument(int index);
+    bool saveDocument(DocumentSession *session, bool closeWhenSaved = false);
+    void onChunkLoaded(quint64 id, const QString &text);
+    void onLoadProgress(quint64 id, qint64 bytesRead, qint64 totalBytes);
+    void onLoadFinished(quint64 id, bool ok, const QString &encoding, const QString &error);
+    void onSaveFinished(quint64 id, const QString &filePath, quint64 revision, bool closeWhenSaved,
+                        bool ok, const QString &error);
+    void updateTitles(DocumentSession *session);
 };
 
 } // namespace SCERSE
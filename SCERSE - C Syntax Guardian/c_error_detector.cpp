@@ -8,6 +8,19 @@
 #include <sstream>
 #include <set>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <chrono>
+#include <climits>
+#include <array>
+#include <deque>
+#include <string_view>
+#include <filesystem>
+#include <utility>
+
+#include "source_encoding.h"
+#include "mapped_file.h"
 
 using namespace std;
 
@@ -15,10 +28,58 @@ using namespace std;
 // Structure of Analysis that is to be returned
 // ============================================================================
 
+struct FunctionMetrics
+{
+    string name;
+    int line = 0;
+    int cyclomaticComplexity = 1; // 1 + decision points (if, while, for, &&, ||)
+    int maxNestingDepth = 0;      // deepest if/loop nesting inside the body
+    int statementCount = 0;
+    int fanIn = 0;                // distinct analyzed functions calling it
+    int fanOut = 0;               // distinct analyzed functions it calls
+};
+
+struct RuleTiming
+{
+    string rule;
+    double milliseconds = 0;
+    size_t calls = 0;
+};
+
+struct SymbolRef
+{
+    string name;
+    string file;
+    int line = 0;
+};
+
+// Where a struct's bytes go on the target ABI
+struct StructLayout
+{
+    string name; // "struct Node"
+    int line = 0;
+    int64_t size = 0;
+    int64_t align = 1;
+    int64_t padding = 0;           // holes between members plus tail padding
+    int64_t optimalSize = 0;       // with the members ordered by decreasing alignment
+    vector<string> straddling;     // members crossing a cache-line boundary
+};
+
+// Whole-program view of the last analysis
+struct CallGraphReport
+{
+    vector<vector<SymbolRef>> cycles; // recursive functions, one entry per strongly connected set
+    vector<SymbolRef> unreachable;    // defined but never reached from main
+};
+
 struct AnalysisResult
 {
     vector<string> lexicalErrors;              // store lexical errors
     vector<pair<string, string>> syntaxErrors; // (error, suggestion)
+    vector<FunctionMetrics> functionMetrics;   // one entry per function definition
+    vector<RuleTiming> ruleTimings;            // filled when rule profiling is on
+    vector<StructLayout> structLayouts;        // one entry per struct definition with a known layout
+    int baselined = 0;                         // findings hidden because the baseline has them
     int totalErrors;
 };
 
@@ -96,6 +157,10 @@ public:
             "Expected type",
             "Type specifier needed: int, float, char, void, double",
             "int x;  float y;  char z;  // <- All have types"));
+        suggestions.push_back(ErrorSuggestion(
+            "Misspelled keyword",
+            "Check the spelling of the keyword or type name",
+            "int x;  return 0;  while (x) { }  // <- Correct spelling"));
         suggestions.push_back(ErrorSuggestion(
             "Missing #endif",
             "Preprocessor conditional #if must have matching #endif",
@@ -120,10 +185,365 @@ public:
     }
 };
 
+// ============================================================================
+// SUPPRESSION MODULE (// scerse-ignore[-next-line|-begin|-end] <code>...)
+// ============================================================================
+
+// Maps a diagnostic message to the short code used in suppression comments;
+// matched by substring like the suggestion table, first entry wins
+class DiagnosticCodes
+{
+public:
+    static const char *classify(const string &message)
+    {
+        static const vector<pair<const char *, const char *>> table = {
+            {"Misspelled keyword", "misspelled-keyword"},
+            {"Undeclared", "undeclared"},
+            {"Redeclaration", "redeclaration"},
+            {"may be used uninitialized", "uninitialized"},
+            {"is declared but never used", "unused-variable"},
+            {"is set but its value is never read", "unused-variable"},
+            {"' is never used", "dead-store"},
+            {"in format string", "format"},
+            {"Format '", "format"},
+            {"arguments for format", "format"},
+            {"Conflicting types for function", "call-arguments"},
+            {"Function call argument mismatch", "call-arguments"},
+            {"argument(s)", "call-arguments"},
+            {"' but parameter expects '", "call-arguments"},
+            {"Array size mismatch", "array-size"},
+            {"Type mismatch", "type-mismatch"},
+            {"Type error", "type-mismatch"},
+            {"not a modifiable lvalue", "lvalue"},
+            {"Duplicated code", "duplicate-code"},
+            {"can overflow its destination buffer", "unsafe-function"},
+            {"Assignment used as the condition", "assignment-in-condition"},
+            {"is octal (leading zero)", "octal-literal"},
+            {"but does not include <", "missing-include"},
+            {"conflicts with its", "extern-mismatch"},
+            {"is also defined in", "multiple-definition"},
+            {"ordering members by alignment", "struct-padding"},
+            {"straddles a", "cache-line-straddle"},
+            {"in the loop condition rescans", "strlen-in-loop-condition"},
+            {"inside a loop rescans the destination", "strcat-in-loop"},
+            {"allocate and release memory on every iteration", "allocation-in-loop"},
+            {") on every call", "large-struct-by-value"},
+        };
+        for (const auto &entry : table)
+        {
+            if (message.find(entry.first) != string::npos)
+                return entry.second;
+        }
+        return "syntax";
+    }
+
+    // Diagnostics are formatted "Line N:C - ..." (possibly after "Warning: "); 0 if absent
+    static int lineOf(const string &message)
+    {
+        size_t at = message.find("Line ");
+        if (at == string::npos)
+            return 0;
+        int line = 0;
+        for (size_t i = at + 5; i < message.size() && isdigit((unsigned char)message[i]); i++)
+            line = line * 10 + (message[i] - '0');
+        return line;
+    }
+};
+
+// Line intervals where diagnostics with the listed codes are dropped. Filled
+// by the lexer as it skips comments; filter() is one sweep over both lists
+// sorted by line, so cost does not depend on how the source looked
+class SuppressionIndex
+{
+private:
+    struct Entry
+    {
+        int firstLine, lastLine;
+        vector<string> codes; // empty: every diagnostic
+    };
+
+    vector<Entry> entries;
+    vector<size_t> open; // unmatched -begin directives
+    bool sorted = true;
+
+    static bool isCodeChar(char c) { return isalnum((unsigned char)c) || c == '-' || c == '_'; }
+
+public:
+    bool empty() const { return entries.empty(); }
+
+    // 'text' is the comment body; startLine/endLine are where the comment begins and ends
+    void addComment(const string &text, int startLine, int endLine)
+    {
+        static const string directive = "scerse-ignore";
+        size_t at = text.find(directive);
+        if (at == string::npos)
+            return;
+        at += directive.size();
+
+        enum
+        {
+            SAME_LINE,
+            NEXT_LINE,
+            BEGIN,
+            END
+        } kind = SAME_LINE;
+        if (text.compare(at, 10, "-next-line") == 0)
+            kind = NEXT_LINE, at += 10;
+        else if (text.compare(at, 6, "-begin") == 0)
+            kind = BEGIN, at += 6;
+        else if (text.compare(at, 4, "-end") == 0)
+            kind = END, at += 4;
+        if (at < text.size() && isCodeChar(text[at]))
+            return; // some other word, e.g. scerse-ignored
+
+        if (kind == END)
+        {
+            if (!open.empty())
+            {
+                entries[open.back()].lastLine = startLine;
+                open.pop_back();
+            }
+            return;
+        }
+
+        // codes are separated by spaces or commas; "--" starts a free-form reason
+        Entry e;
+        while (at < text.size())
+        {
+            while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == ','))
+                at++;
+            size_t end = at;
+            while (end < text.size() && isCodeChar(text[end]))
+                end++;
+            if (end == at || text.compare(at, 2, "--") == 0)
+                break;
+            e.codes.push_back(text.substr(at, end - at));
+            at = end;
+        }
+
+        if (kind == NEXT_LINE)
+            e.firstLine = e.lastLine = endLine + 1;
+        else if (kind == BEGIN)
+            e.firstLine = startLine, e.lastLine = INT_MAX; // until the matching -end
+        else
+            e.firstLine = e.lastLine = startLine;
+
+        if (!entries.empty() && entries.back().firstLine > e.firstLine)
+            sorted = false;
+        if (kind == BEGIN)
+            open.push_back(entries.size());
+        entries.push_back(move(e));
+    }
+
+    // Removes suppressed diagnostics, keeping the order of the rest
+    template <typename T, typename MessageOf>
+    void filter(vector<T> &diags, MessageOf messageOf)
+    {
+        if (entries.empty() || diags.empty())
+            return;
+        if (!sorted)
+        {
+            // -begin indices in 'open' refer to the old order; they are closed by now or run to EOF
+            stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                        { return a.firstLine < b.firstLine; });
+            open.clear();
+            sorted = true;
+        }
+
+        vector<pair<int, size_t>> byLine; // (line, diagnostic index)
+        byLine.reserve(diags.size());
+        for (size_t i = 0; i < diags.size(); i++)
+        {
+            int line = DiagnosticCodes::lineOf(messageOf(diags[i]));
+            if (line > 0)
+                byLine.push_back({line, i});
+        }
+        sort(byLine.begin(), byLine.end());
+
+        vector<uint8_t> drop(diags.size(), 0);
+        vector<const Entry *> active;
+        size_t next = 0;
+        for (const auto &d : byLine)
+        {
+            while (next < entries.size() && entries[next].firstLine <= d.first)
+                active.push_back(&entries[next++]);
+            active.erase(remove_if(active.begin(), active.end(), [&](const Entry *e)
+                                   { return e->lastLine < d.first; }),
+                         active.end());
+            if (active.empty())
+                continue;
+
+            const char *code = DiagnosticCodes::classify(messageOf(diags[d.second]));
+            for (const Entry *e : active)
+            {
+                if (e->codes.empty() || find(e->codes.begin(), e->codes.end(), code) != e->codes.end())
+                {
+                    drop[d.second] = 1;
+                    break;
+                }
+            }
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < diags.size(); i++)
+        {
+            if (!drop[i])
+                diags[kept++] = move(diags[i]);
+        }
+        diags.resize(kept);
+    }
+};
+
+// ============================================================================
+// STRING INTERNING MODULE
+// ============================================================================
+
+// Maps names and type spellings to dense integer IDs, so hot lookups compare
+// integers. Each engine owns one; the engine's calls make it current() on
+// their thread. Names never move, so name() references stay valid.
+class StringInterner
+{
+private:
+    unordered_map<string, uint32_t> ids;
+    deque<string> names;
+    size_t characters = 0;
+
+    static inline thread_local StringInterner *active = nullptr;
+
+public:
+    uint32_t intern(const string &s)
+    {
+        auto it = ids.find(s);
+        if (it != ids.end())
+            return it->second;
+        uint32_t id = names.size();
+        names.push_back(s);
+        ids.emplace(s, id);
+        characters += s.size();
+        return id;
+    }
+
+    const string &name(uint32_t id) const { return names[id]; }
+
+    // Approximate heap use: each name is stored twice, plus the hash nodes
+    size_t bytes() const { return 2 * characters + names.size() * (2 * sizeof(string) + 32); }
+
+    // The standard library tables intern into this one, once per process;
+    // engines start from a copy, so those IDs mean the same everywhere
+    static StringInterner &builtin()
+    {
+        static StringInterner base;
+        return base;
+    }
+
+    static StringInterner &current() { return active ? *active : builtin(); }
+
+    // Makes an interner current on this thread for one engine call
+    class Use
+    {
+        StringInterner *saved;
+
+    public:
+        explicit Use(StringInterner &interner) : saved(active) { active = &interner; }
+        ~Use() { active = saved; }
+        Use(const Use &) = delete;
+        Use &operator=(const Use &) = delete;
+    };
+};
+
+// ============================================================================
+// FUNCTION SIGNATURE MODULE
+// ============================================================================
+
+struct FunctionSignature
+{
+    uint32_t returnType = 0;      // interned, normalized type
+    vector<uint32_t> paramTypes;  // interned, normalized types
+    bool variadic = false;
+    bool defined = false; // a body was seen (user functions only)
+    bool internal = false; // declared static, here or earlier (user functions only)
+    int8_t header = -1;   // StandardHeader declaring it (library functions only)
+
+    // Spelling used for comparisons: drops const, maps size_t/unsigned to integer types
+    static string normalizeType(const string &type)
+    {
+        string base;
+        size_t stars = count(type.begin(), type.end(), '*');
+        stringstream ss(type);
+        string word;
+        while (ss >> word)
+        {
+            word.erase(remove(word.begin(), word.end(), '*'), word.end());
+            if (word.empty() || word == "const")
+                continue;
+            base += (base.empty() ? "" : " ") + word;
+        }
+
+        if (base == "size_t" || base == "unsigned long")
+            base = "long";
+        else if (base == "unsigned" || base == "unsigned int")
+            base = "int";
+        else if (base == "unsigned char")
+            base = "char";
+        return base + string(stars, '*');
+    }
+
+    // Parses "int printf(const char* format, ...)" into structured form
+    static FunctionSignature parse(const string &decl, string &name, StringInterner &ids)
+    {
+        FunctionSignature sig;
+
+        size_t open = decl.find('(');
+        size_t close = decl.rfind(')');
+        string head = decl.substr(0, open);
+        size_t nameStart = head.find_last_of(" *") + 1;
+        name = head.substr(nameStart);
+        sig.returnType = ids.intern(normalizeType(head.substr(0, nameStart)));
+
+        stringstream params(decl.substr(open + 1, close - open - 1));
+        string param;
+        while (getline(params, param, ','))
+        {
+            param.erase(0, param.find_first_not_of(" \t"));
+            param.erase(param.find_last_not_of(" \t") + 1);
+            if (param == "...")
+            {
+                sig.variadic = true;
+                continue;
+            }
+            if (param.empty() || param == "void")
+                continue;
+            // drop the parameter name: "const char* format" -> "const char*"
+            string type = param.substr(0, param.find_last_of(" *") + 1);
+            sig.paramTypes.push_back(ids.intern(normalizeType(type)));
+        }
+        return sig;
+    }
+
+    bool sameShape(const FunctionSignature &other) const
+    {
+        return returnType == other.returnType && paramTypes == other.paramTypes &&
+               variadic == other.variadic;
+    }
+};
+
+// function name id -> signature
+typedef unordered_map<uint32_t, FunctionSignature> SignatureTable;
+
 // ============================================================================
 // STANDARD LIBRARY MODULE (stdio, stdlib, etc.)
 // ============================================================================
 
+// Headers the catalogued functions come from; bit positions in a HeaderSet
+enum StandardHeader : int8_t
+{
+    STDIO_H,
+    STDLIB_H,
+    STRING_H,
+    MATH_H
+};
+typedef uint32_t HeaderSet;
+
 // so that include statements and built-in functions can be recognized
 class StandardLibrary
 {
@@ -132,7 +552,6 @@ private:
     unordered_set<string> stdlibFunctions;
     unordered_set<string> stringFunctions;
     unordered_set<string> mathFunctions;
-    unordered_map<string, string> functionSignatures;
 
 public:
     StandardLibrary()
@@ -146,7 +565,7 @@ public:
         // stdlib.h functions
         stdlibFunctions = {
             "malloc", "calloc", "realloc", "free", "exit", "abort",
-            "atoi", "atof", "atol", "rand", "srand", "qsort"};
+            "atoi", "atof", "atol", "rand", "srand", "qsort", "abs"};
 
         // string.h functions
         stringFunctions = {
@@ -155,22 +574,94 @@ public:
 
         // math.h functions
         mathFunctions = {
-            "sin", "cos", "tan", "sqrt", "pow", "abs", "floor", "ceil"};
+            "sin", "cos", "tan", "sqrt", "pow", "floor", "ceil"};
+    }
 
-        // Function signatures for type checking
+    static const char *headerName(int8_t header)
+    {
+        static const char *const names[] = {"stdio.h", "stdlib.h", "string.h", "math.h"};
+        return names[header];
+    }
 
-        // variadic
-        functionSignatures["printf"] = "int printf(const char* format, ...)";
-        functionSignatures["scanf"] = "int scanf(const char* format, ...)";
-        functionSignatures["fprintf"] = "int fprintf(FILE* stream, const char* format, ...)";
-        functionSignatures["sprintf"] = "int sprintf(char* str, const char* format, ...)";
-        functionSignatures["sscanf"] = "int sscanf(const char* buffer, const char* format, ...)";
-        functionSignatures["fscanf"] = "int fscanf(FILE* stream, const char* format, ...)";
+    // "string.h" -> STRING_H; -1 for headers outside the catalogue
+    static int8_t headerId(const string &name)
+    {
+        for (int8_t h = STDIO_H; h <= MATH_H; h++)
+            if (name == headerName(h))
+                return h;
+        return -1;
+    }
 
-        // non-variadic
-        functionSignatures["malloc"] = "void* malloc(size_t size)";
-        functionSignatures["free"] = "void free(void* ptr)";
-        functionSignatures["strlen"] = "size_t strlen(const char* s)";
+    // Signatures of the catalogued functions, parsed once per process and keyed by interned name
+    static const SignatureTable &librarySignatures()
+    {
+        static const SignatureTable table = []
+        {
+            const pair<StandardHeader, vector<const char *>> headers[] = {
+                {STDIO_H,
+                 {"int printf(const char* format, ...)",
+                  "int scanf(const char* format, ...)",
+                  "int fprintf(FILE* stream, const char* format, ...)",
+                  "int sprintf(char* str, const char* format, ...)",
+                  "int sscanf(const char* buffer, const char* format, ...)",
+                  "int fscanf(FILE* stream, const char* format, ...)",
+                  "FILE* fopen(const char* filename, const char* mode)",
+                  "int fclose(FILE* stream)",
+                  "size_t fread(void* buffer, size_t size, size_t count, FILE* stream)",
+                  "size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream)",
+                  "char* fgets(char* str, int count, FILE* stream)",
+                  "int fputs(const char* str, FILE* stream)",
+                  "int getchar(void)",
+                  "int putchar(int ch)",
+                  "char* gets(char* str)",
+                  "int puts(const char* str)",
+                  "void perror(const char* s)"}},
+                {STDLIB_H,
+                 {"void* malloc(size_t size)",
+                  "void* calloc(size_t num, size_t size)",
+                  "void* realloc(void* ptr, size_t new_size)",
+                  "void free(void* ptr)",
+                  "void exit(int status)",
+                  "void abort(void)",
+                  "int atoi(const char* str)",
+                  "double atof(const char* str)",
+                  "long atol(const char* str)",
+                  "int rand(void)",
+                  "void srand(unsigned seed)",
+                  "void qsort(void* base, size_t count, size_t size, void* comp)",
+                  "int abs(int n)"}},
+                {STRING_H,
+                 {"char* strcpy(char* dest, const char* src)",
+                  "char* strncpy(char* dest, const char* src, size_t count)",
+                  "size_t strlen(const char* s)",
+                  "int strcmp(const char* lhs, const char* rhs)",
+                  "char* strcat(char* dest, const char* src)",
+                  "char* strchr(const char* str, int ch)",
+                  "char* strstr(const char* str, const char* substr)",
+                  "void* memset(void* dest, int ch, size_t count)",
+                  "void* memcpy(void* dest, const void* src, size_t count)",
+                  "void* memmove(void* dest, const void* src, size_t count)"}},
+                {MATH_H,
+                 {"double sin(double arg)",
+                  "double cos(double arg)",
+                  "double tan(double arg)",
+                  "double sqrt(double arg)",
+                  "double pow(double base, double exponent)",
+                  "double floor(double arg)",
+                  "double ceil(double arg)"}}};
+
+            SignatureTable t;
+            for (const auto &group : headers)
+                for (const char *decl : group.second)
+                {
+                    string name;
+                    FunctionSignature sig = FunctionSignature::parse(decl, name, StringInterner::builtin());
+                    sig.header = group.first;
+                    t[StringInterner::builtin().intern(name)] = sig;
+                }
+            return t;
+        }();
+        return table;
     }
 
     bool isStdioFunction(const string &name) const { return stdioFunctions.count(name) > 0; }
@@ -183,10 +674,18 @@ public:
                isStringFunction(name) || isMathFunction(name);
     }
 
-    string getFunctionSignature(const string &name) const
+    // An interner holding every name the signature tables use, for a new engine
+    static StringInterner newInterner()
     {
-        auto it = functionSignatures.find(name);
-        return it != functionSignatures.end() ? it->second : "";
+        librarySignatures();
+        return StringInterner::builtin();
+    }
+
+    const FunctionSignature *getFunctionSignature(uint32_t nameId) const
+    {
+        const SignatureTable &table = librarySignatures();
+        auto it = table.find(nameId);
+        return it != table.end() ? &it->second : nullptr;
     }
 };
 
@@ -198,7 +697,7 @@ class PreprocessorHandler
 {
 private:
     vector<string> errors;
-    unordered_set<string> includedHeaders;
+    HeaderSet includedHeaders = 0; // bit per StandardHeader
 
 public:
     void processInclude(const string &line, int lineNum)
@@ -215,8 +714,9 @@ public:
             return;
         }
 
-        string headerName = line.substr(start + 1, end - start - 1);
-        includedHeaders.insert(headerName);
+        int8_t header = StandardLibrary::headerId(line.substr(start + 1, end - start - 1));
+        if (header >= 0)
+            includedHeaders |= HeaderSet(1) << header;
     }
 
     void processPreprocessor(const string &line, int lineNum)
@@ -231,10 +731,7 @@ public:
         }
     }
 
-    bool isHeaderIncluded(const string &header) const
-    {
-        return includedHeaders.count(header) > 0;
-    }
+    bool isHeaderIncluded(int8_t header) const { return (includedHeaders >> header) & 1; }
 
     vector<string> getErrors() const { return errors; }
 };
@@ -247,6 +744,7 @@ enum class TokenType
 {
     TOK_EOF,
     TOK_IDENTIFIER,
+    TYPEDEF_NAME, // identifier the parser has seen declared by typedef
     TOK_NUMBER,
     TOK_STRING,
     TOK_CHAR,
@@ -272,6 +770,7 @@ enum class TokenType
     KW_STATIC,
     KW_EXTERN,
     KW_STRUCT,
+    KW_ENUM,
     KW_AUTO,
     OP_PLUS,
     OP_MINUS,
@@ -285,6 +784,8 @@ enum class TokenType
     OP_GT,
     OP_LE,
     OP_GE,
+    OP_SHL,
+    OP_SHR,
     OP_AND,
     OP_OR,
     OP_NOT,
@@ -316,12 +817,31 @@ enum class TokenType
     TOK_UNKNOWN
 };
 
+// What the lexer learned about a numeric literal (Token::numFlags)
+enum NumberFlags : uint8_t
+{
+    NUM_FLOAT = 1 << 0,    // has '.', an exponent or a 'p' exponent
+    NUM_HEX = 1 << 1,
+    NUM_OCTAL = 1 << 2,    // integer with a leading zero, e.g. 017
+    NUM_BINARY = 1 << 3,
+    NUM_UNSIGNED = 1 << 4, // u/U suffix
+    NUM_LONG = 1 << 5,     // l/L suffix (long double on a floating constant)
+    NUM_LONGLONG = 1 << 6, // ll/LL suffix
+    NUM_FSUFFIX = 1 << 7   // f/F suffix
+};
+
 struct Token
 {
     TokenType type;
-    string value; // which token it is as read from source
+    uint8_t numFlags = 0; // NumberFlags, TOK_NUMBER only (fits in type's padding)
+    string value;         // which token it is as read from source
     int line;
     int column;
+    union                 // parsed value of a TOK_NUMBER, for constant folding
+    {
+        uint64_t intValue = 0;
+        double floatValue;
+    };
     Token(TokenType t = TokenType::TOK_UNKNOWN, string v = "", int l = 1, int c = 1)
         : type(t), value(v), line(l), column(c) {}
 };
@@ -330,57 +850,85 @@ struct Token
 // LEXER MODULE
 // ============================================================================
 
+// Scans the caller's buffer in place (it may be a mapped file): CRLF and lone CR
+// line endings and backslash-newline splices are handled by the scanning
+// primitives rather than by normalizing a copy
 class Lexer
 {
 private:
-    string input;
+    string_view input;
     size_t pos;
     int line, column;
     vector<string> errors;
-    PreprocessorHandler preprocessor;
-
-    unordered_map<string, TokenType> keywords = {
-        {"int", TokenType::KW_INT},
-        {"float", TokenType::KW_FLOAT},
-        {"char", TokenType::KW_CHAR},
-        {"void", TokenType::KW_VOID},
-        {"double", TokenType::KW_DOUBLE},
-        {"if", TokenType::KW_IF},
-        {"else", TokenType::KW_ELSE},
-        {"while", TokenType::KW_WHILE},
-        {"for", TokenType::KW_FOR},
-        {"do", TokenType::KW_DO},
-        {"return", TokenType::KW_RETURN},
-        {"break", TokenType::KW_BREAK},
-        {"continue", TokenType::KW_CONTINUE},
-        {"switch", TokenType::KW_SWITCH},
-        {"case", TokenType::KW_CASE},
-        {"default", TokenType::KW_DEFAULT},
-        {"struct", TokenType::KW_STRUCT},
-        {"typedef", TokenType::KW_TYPEDEF},
-        {"sizeof", TokenType::KW_SIZEOF},
-        {"const", TokenType::KW_CONST},
-        {"static", TokenType::KW_STATIC},
-        {"extern", TokenType::KW_EXTERN},
-        {"auto", TokenType::KW_AUTO}};
+    SuppressionIndex suppressions;
+
+    // Cheap pre-check so ordinary comments are never copied
+    void noteComment(size_t start, size_t end, int startLine)
+    {
+        static const char directive[] = "scerse-ignore";
+        auto first = input.begin() + start, last = input.begin() + end;
+        if (search(first, last, directive, directive + sizeof(directive) - 1) != last)
+            suppressions.addComment(string(input.substr(start, end - start)), startLine, line);
+    }
+
+    // Index just past any backslash-newline splices starting at i ("\\\n", "\\\r\n", "\\\r")
+    size_t spliceEnd(size_t i, int *lines = nullptr) const
+    {
+        while (i < input.size() && input[i] == '\\')
+        {
+            size_t next = i + 1;
+            if (next < input.size() && input[next] == '\r')
+                next++;
+            if (next < input.size() && input[next] == '\n')
+                next++;
+            if (next == i + 1)
+                break; // an ordinary backslash
+            i = next;
+            if (lines)
+                ++*lines;
+        }
+        return i;
+    }
 
     char currentChar() { return pos >= input.length() ? '\0' : input[pos]; }
-    char peekChar(int offset = 1) { return pos + offset >= input.length() ? '\0' : input[pos + offset]; }
+    char peekChar(int offset = 1)
+    {
+        size_t i = pos;
+        for (int k = 0; k < offset && i < input.size(); k++)
+            i = spliceEnd(i + 1);
+        return i >= input.length() ? '\0' : input[i];
+    }
+
+    // '\r' ends a line on its own (old Mac files) and is absorbed into "\r\n"
+    bool atLineEnd() { return currentChar() == '\n' || currentChar() == '\r' || currentChar() == '\0'; }
 
     void advance() // move to next character
     {
         if (pos < input.length())
         {
-            if (input[pos] == '\n')
+            char c = input[pos++];
+            if (c == '\n' || (c == '\r' && currentChar() != '\n'))
             {
                 line++;
                 column = 1;
             }
-            else
+            else if (c != '\r') // the '\n' of "\r\n" ends the line
             {
                 column++;
             }
-            pos++;
+            skipSplices();
+        }
+    }
+
+    void skipSplices()
+    {
+        int lines = 0;
+        size_t next = spliceEnd(pos, &lines);
+        if (lines)
+        {
+            pos = next;
+            line += lines;
+            column = 1;
         }
     }
 
@@ -394,14 +942,18 @@ private:
     {
         if (currentChar() == '/' && peekChar() == '/')
         {
-            while (currentChar() != '\n' && currentChar() != '\0')
+            int cLine = line;
+            size_t start = pos + 2;
+            while (!atLineEnd())
                 advance();
+            noteComment(start, pos, cLine);
         }
         else if (currentChar() == '/' && peekChar() == '*')
         {
             int cLine = line, cCol = column;
             advance();
             advance();
+            size_t start = pos;
             while (true)
             {
                 if (currentChar() == '\0')
@@ -411,6 +963,7 @@ private:
                 }
                 if (currentChar() == '*' && peekChar() == '/')
                 {
+                    noteComment(start, pos, cLine);
                     advance();
                     advance();
                     break;
@@ -420,46 +973,249 @@ private:
         }
     }
 
+    // Digit classes for numeric literals: bit set when the byte is a digit in that radix
+    enum : uint8_t
+    {
+        DIG_BIN = 1,
+        DIG_OCT = 2,
+        DIG_DEC = 4,
+        DIG_HEX = 8
+    };
+
+    static const uint8_t *digitClasses()
+    {
+        static const auto table = []
+        {
+            array<uint8_t, 256> t{};
+            for (int c = '0'; c <= '9'; c++)
+                t[c] = DIG_DEC | DIG_HEX | (c <= '7' ? DIG_OCT : 0) | (c <= '1' ? DIG_BIN : 0);
+            for (int c = 'a'; c <= 'f'; c++)
+                t[c] = t[c - 'a' + 'A'] = DIG_HEX;
+            return t;
+        }();
+        return table.data();
+    }
+
+    // u/U combined with l/L/ll/LL in either order; "lL" is not a valid suffix
+    static const unordered_map<string, uint8_t> &integerSuffixes()
+    {
+        static const auto table = []
+        {
+            unordered_map<string, uint8_t> t;
+            const pair<const char *, uint8_t> u[] = {{"", 0}, {"u", NUM_UNSIGNED}, {"U", NUM_UNSIGNED}};
+            const pair<const char *, uint8_t> l[] = {{"", 0}, {"l", NUM_LONG}, {"L", NUM_LONG},
+                                                     {"ll", NUM_LONGLONG}, {"LL", NUM_LONGLONG}};
+            for (auto &a : u)
+                for (auto &b : l)
+                {
+                    t[string(a.first) + b.first] = a.second | b.second;
+                    t[string(b.first) + a.first] = a.second | b.second;
+                }
+            return t;
+        }();
+        return table;
+    }
+
+    // The literal is reported here and still reaches the parser as a number,
+    // so one bad digit does not cascade into statement-level errors
+    Token numberError(const string &num, const string &why, int sL, int sC)
+    {
+        errors.push_back("Line " + to_string(sL) + ":" + to_string(sC) + " - Invalid numeric literal '" + num + "': " + why);
+        return Token(TokenType::TOK_NUMBER, num, sL, sC);
+    }
+
+    // Full C literal grammar: decimal, octal, hex and binary integers, decimal and
+    // hex floats, exponents and suffixes. Plain decimal integers take a fast path
     Token lexNumber()
     {
         int sL = line, sC = column;
-        string num;
-        bool hasDec = false;
-        while (isdigit(currentChar()) || currentChar() == '.')
+        const uint8_t *digits = digitClasses();
+        size_t start = pos, n = input.size();
+        auto at = [&](size_t i) -> unsigned char
+        { return i < n ? input[i] : 0; };
+
+        uint64_t value = 0;
+        bool overflow = false;
+        auto accumulate = [&](unsigned radix, unsigned char c)
+        {
+            unsigned d = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            if (value > (UINT64_MAX - d) / radix)
+                overflow = true;
+            value = value * radix + d;
+        };
+
+        // Fast path: "42" or "0" with nothing attached
+        size_t i = pos;
+        while (digits[at(i)] & DIG_DEC)
+            accumulate(10, at(i++));
+        unsigned char next = at(i);
+        if (i > start && !isalnum(next) && next != '_' && next != '.' && (at(start) != '0' || i - start == 1))
+        {
+            string num(input.substr(start, i - start));
+            column += int(i - pos);
+            pos = i;
+            skipSplices();
+            if (overflow)
+                return numberError(num, "integer constant is too large", sL, sC);
+            Token tok(TokenType::TOK_NUMBER, num, sL, sC);
+            tok.intValue = value;
+            return tok;
+        }
+
+        // General path: take the whole preprocessing number, then validate it
+        size_t end = start;
+        while (isalnum(at(end)) || at(end) == '_' || at(end) == '.')
+        {
+            unsigned char c = at(end++);
+            if ((c == 'e' || c == 'E' || c == 'p' || c == 'P') && (at(end) == '+' || at(end) == '-'))
+                end++;
+        }
+        string num(input.substr(start, end - start));
+        column += int(end - pos);
+        pos = end;
+        skipSplices();
+
+        uint8_t flags = 0;
+        unsigned radix = 10;
+        uint8_t cls = DIG_DEC;
+        size_t k = 0, len = num.size();
+        if (len > 1 && num[0] == '0' && (num[1] | 0x20) == 'x')
+        {
+            radix = 16, cls = DIG_HEX, flags |= NUM_HEX, k = 2;
+        }
+        else if (len > 1 && num[0] == '0' && (num[1] | 0x20) == 'b')
+        {
+            radix = 2, cls = DIG_BIN, flags |= NUM_BINARY, k = 2;
+        }
+
+        value = 0;
+        overflow = false;
+        size_t intStart = k;
+        while (k < len && (digits[(unsigned char)num[k]] & cls))
+            accumulate(radix, num[k++]);
+        size_t mantissaDigits = k - intStart;
+
+        bool exponent = false;
+        if (radix != 2 && k < len && num[k] == '.')
+        {
+            flags |= NUM_FLOAT;
+            k++;
+            while (k < len && (digits[(unsigned char)num[k]] & cls))
+                k++, mantissaDigits++;
+        }
+        if (radix != 2 && k < len && (num[k] | 0x20) == (radix == 16 ? 'p' : 'e'))
         {
-            if (currentChar() == '.')
+            flags |= NUM_FLOAT;
+            exponent = true;
+            k++;
+            if (k < len && (num[k] == '+' || num[k] == '-'))
+                k++;
+            size_t expStart = k;
+            while (k < len && (digits[(unsigned char)num[k]] & DIG_DEC))
+                k++;
+            if (k == expStart)
+                return numberError(num, "exponent has no digits", sL, sC);
+        }
+
+        if (mantissaDigits == 0)
+            return numberError(num, "no digits", sL, sC);
+        if (radix == 16 && (flags & NUM_FLOAT) && !exponent)
+            return numberError(num, "hexadecimal floating constant requires a 'p' exponent", sL, sC);
+
+        string suffix = num.substr(k);
+        if (suffix.find('.') != string::npos)
+            return numberError(num, "multiple decimal points", sL, sC);
+
+        if (flags & NUM_FLOAT)
+        {
+            if (suffix == "f" || suffix == "F")
+                flags |= NUM_FSUFFIX;
+            else if (suffix == "l" || suffix == "L")
+                flags |= NUM_LONG;
+            else if (!suffix.empty())
+                return numberError(num, "invalid suffix '" + suffix + "' on floating constant", sL, sC);
+
+            Token tok(TokenType::TOK_NUMBER, num, sL, sC);
+            tok.numFlags = flags;
+            tok.floatValue = strtod(num.substr(0, k).c_str(), nullptr);
+            return tok;
+        }
+
+        // a leading zero makes an integer octal
+        if (radix == 10 && num[0] == '0' && k > 1)
+        {
+            flags |= NUM_OCTAL;
+            value = 0;
+            overflow = false;
+            for (size_t d = 1; d < k; d++)
             {
-                if (hasDec)
-                    errors.push_back("Line " + to_string(line) + ":" + to_string(column) + " - Invalid numeric literal: multiple decimal points");
-                hasDec = true;
+                if (!(digits[(unsigned char)num[d]] & DIG_OCT))
+                    return numberError(num, string("invalid digit '") + num[d] + "' in octal constant", sL, sC);
+                accumulate(8, num[d]);
             }
-            num += currentChar();
+        }
+
+        auto sfx = integerSuffixes().find(suffix);
+        if (sfx == integerSuffixes().end())
+        {
+            if (radix == 2 && k < len && isdigit((unsigned char)num[k]))
+                return numberError(num, string("invalid digit '") + num[k] + "' in binary constant", sL, sC);
+            return numberError(num, "invalid suffix '" + suffix + "' on integer constant", sL, sC);
+        }
+        if (overflow)
+            return numberError(num, "integer constant is too large", sL, sC);
+
+        Token tok(TokenType::TOK_NUMBER, num, sL, sC);
+        tok.numFlags = flags | sfx->second;
+        tok.intValue = value;
+        return tok;
+    }
+
+    // A run of bytes outside C's source character set, reported once: a UTF-8
+    // character shows intact in the message, ill-formed bytes as \xNN
+    string lexNonASCII()
+    {
+        int sL = line, sC = column;
+        string text;
+        while ((unsigned char)currentChar() >= 0x80)
+        {
+            text += currentChar();
             advance();
         }
-        if (isalpha(currentChar()))
+        string shown = text;
+        if (utf8ValidPrefix(text.data(), text.size()) != text.size())
         {
-            errors.push_back("Line " + to_string(line) + ":" + to_string(column) + " - Invalid numeric literal");
-            while (isalnum(currentChar()))
+            shown.clear();
+            for (unsigned char b : text)
             {
-                num += currentChar();
-                advance();
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\x%02X", b);
+                shown += buf;
             }
-            return Token(TokenType::TOK_ERROR, num, sL, sC);
         }
-        return Token(TokenType::TOK_NUMBER, num, sL, sC);
+        errors.push_back("Line " + to_string(sL) + ":" + to_string(sC) + " - Invalid character: '" + shown + "'");
+        return text;
     }
 
     Token lexIdentifier()
     {
         int sL = line, sC = column;
         string id;
-        while (isalnum(currentChar()) || currentChar() == '_')
+        while (true)
         {
-            id += currentChar();
-            advance();
+            if (isalnum(currentChar()) || currentChar() == '_')
+            {
+                id += currentChar();
+                advance();
+            }
+            else if ((unsigned char)currentChar() >= 0x80) // café stays one identifier
+                id += lexNonASCII();
+            else
+                break;
         }
-        if (keywords.find(id) != keywords.end())
-            return Token(keywords[id], id, sL, sC);
+        auto kw = keywords().find(id);
+        if (kw != keywords().end())
+            return Token(kw->second, id, sL, sC);
         return Token(TokenType::TOK_IDENTIFIER, id, sL, sC);
     }
 
@@ -489,7 +1245,7 @@ private:
             }
 
             // Newline in string = unterminated error
-            if (c == '\n')
+            if (c == '\n' || c == '\r')
             {
                 errors.push_back("Line " + to_string(sL) + ":" + to_string(sC) +
                                  " - Unterminated string literal (newline in string)");
@@ -555,7 +1311,7 @@ private:
             }
 
             // Newline in char = unterminated error
-            if (c == '\n')
+            if (c == '\n' || c == '\r')
             {
                 errors.push_back("Line " + to_string(sL) + ":" + to_string(sC) +
                                  " - Unterminated character literal (newline in char)");
@@ -611,7 +1367,39 @@ private:
     }
 
 public:
-    Lexer(const string &src) : input(src), pos(0), line(1), column(1) {}
+    // keyword spelling -> token type, shared with the keyword spell checker
+    static const unordered_map<string, TokenType> &keywords()
+    {
+        static const unordered_map<string, TokenType> table = {
+            {"int", TokenType::KW_INT},
+            {"float", TokenType::KW_FLOAT},
+            {"char", TokenType::KW_CHAR},
+            {"void", TokenType::KW_VOID},
+            {"double", TokenType::KW_DOUBLE},
+            {"if", TokenType::KW_IF},
+            {"else", TokenType::KW_ELSE},
+            {"while", TokenType::KW_WHILE},
+            {"for", TokenType::KW_FOR},
+            {"do", TokenType::KW_DO},
+            {"return", TokenType::KW_RETURN},
+            {"break", TokenType::KW_BREAK},
+            {"continue", TokenType::KW_CONTINUE},
+            {"switch", TokenType::KW_SWITCH},
+            {"case", TokenType::KW_CASE},
+            {"default", TokenType::KW_DEFAULT},
+            {"struct", TokenType::KW_STRUCT},
+            {"enum", TokenType::KW_ENUM},
+            {"typedef", TokenType::KW_TYPEDEF},
+            {"sizeof", TokenType::KW_SIZEOF},
+            {"const", TokenType::KW_CONST},
+            {"static", TokenType::KW_STATIC},
+            {"extern", TokenType::KW_EXTERN},
+            {"auto", TokenType::KW_AUTO}};
+        return table;
+    }
+
+    // src must outlive the lexer
+    explicit Lexer(string_view src) : input(src), pos(0), line(1), column(1) { skipSplices(); }
 
     Token getNextToken()
     {
@@ -632,16 +1420,15 @@ public:
         if (c == '#')
         {
             string prep;
-            while (currentChar() != '\n' && currentChar() != '\0')
+            while (!atLineEnd())
             {
                 prep += currentChar();
                 advance();
             }
-            preprocessor.processPreprocessor(prep, sL);
             return Token(TokenType::PREPROCESSOR, prep, sL, sC);
         }
 
-        if (isdigit(c))
+        if (isdigit(c) || (c == '.' && isdigit((unsigned char)peekChar())))
             return lexNumber();
         if (isalpha(c) || c == '_')
             return lexIdentifier();
@@ -766,6 +1553,11 @@ public:
                 advance();
                 return Token(TokenType::OP_LE, "<=", sL, sC);
             }
+            if (currentChar() == '<')
+            {
+                advance();
+                return Token(TokenType::OP_SHL, "<<", sL, sC);
+            }
             return Token(TokenType::OP_LT, "<", sL, sC);
         case '>':
             advance();
@@ -774,6 +1566,11 @@ public:
                 advance();
                 return Token(TokenType::OP_GE, ">=", sL, sC);
             }
+            if (currentChar() == '>')
+            {
+                advance();
+                return Token(TokenType::OP_SHR, ">>", sL, sC);
+            }
             return Token(TokenType::OP_GT, ">", sL, sC);
         case '&':
             advance();
@@ -798,6 +1595,13 @@ public:
             advance();
             return Token(TokenType::OP_BITNOT, "~", sL, sC);
         default:
+            if ((unsigned char)c >= 0x80)
+            {
+                string text = lexNonASCII();
+                if (isalnum(currentChar()) || currentChar() == '_')
+                    return Token(TokenType::TOK_IDENTIFIER, text + lexIdentifier().value, sL, sC);
+                return Token(TokenType::TOK_ERROR, text, sL, sC);
+            }
             errors.push_back("Line " + to_string(line) + ":" + to_string(column) + " - Invalid character: '" + string(1, c) + "'");
             advance();
             return Token(TokenType::TOK_ERROR, string(1, c), sL, sC);
@@ -805,6 +1609,7 @@ public:
     }
 
     vector<string> getErrors() const { return errors; } // stored in a list for recovery and showing all errors at once
+    const SuppressionIndex &getSuppressions() const { return suppressions; }
 
     vector<Token> tokenizeAll()
     {
@@ -820,43 +1625,160 @@ public:
 };
 
 // ============================================================================
-// SYMBOL TABLE MODULE
+// KEYWORD SPELL CHECK MODULE (itn -> int, retrun -> return, whiel -> while)
 // ============================================================================
 
-struct VarInfo
-{
-    string name, type;
-    int line, column; // Track where variable was declared
-    VarInfo(string n = "", string t = "", int l = 0, int c = 0)
-        : name(n), type(t), line(l), column(c) {}
-};
-
-class TypeSystem
+// Trigram index over the lexer's keyword table, built once per process.
+// A lookup only runs the edit-distance check on keywords sharing a trigram with the word.
+class KeywordSpellChecker
 {
 public:
-    // Check if two types are compatible
-    static bool isInteger(const string &t)
+    struct Entry
     {
-        return t == "int" || t == "long" || t == "short";
-    }
+        string word;
+        TokenType type;
+    };
 
-    static bool isFloat(const string &t)
-    {
-        return t == "float" || t == "double";
-    }
+private:
+    vector<Entry> entries;
+    unordered_map<uint32_t, vector<uint8_t>> trigramIndex; // trigram -> entry ids
 
-    static bool isChar(const string &t)
+    // words are padded as "$$word$$" so short keywords still get a few trigrams
+    static vector<uint32_t> trigramsOf(const string &word)
     {
-        return t == "char";
+        string padded = "$$" + word + "$$";
+        vector<uint32_t> grams;
+        for (size_t i = 0; i + 3 <= padded.size(); i++)
+        {
+            grams.push_back((uint32_t(uint8_t(padded[i])) << 16) |
+                            (uint32_t(uint8_t(padded[i + 1])) << 8) |
+                            uint32_t(uint8_t(padded[i + 2])));
+        }
+        return grams;
     }
 
-    static bool isString(const string &t)
+    // Optimal string alignment distance (a swap of two neighbours counts as one edit)
+    static int editDistance(const string &a, const string &b)
     {
-        return t == "string";
-    }
+        vector<vector<int>> d(a.size() + 1, vector<int>(b.size() + 1, 0));
+        for (size_t i = 0; i <= a.size(); i++)
+            d[i][0] = i;
+        for (size_t j = 0; j <= b.size(); j++)
+            d[0][j] = j;
 
-    static bool isPointer(const string &t)
-    {
+        for (size_t i = 1; i <= a.size(); i++)
+        {
+            for (size_t j = 1; j <= b.size(); j++)
+            {
+                int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+                d[i][j] = min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + cost});
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                    d[i][j] = min(d[i][j], d[i - 2][j - 2] + 1);
+            }
+        }
+        return d[a.size()][b.size()];
+    }
+
+public:
+    KeywordSpellChecker()
+    {
+        for (const auto &kw : Lexer::keywords())
+        {
+            uint8_t id = entries.size();
+            entries.push_back({kw.first, kw.second});
+            for (uint32_t g : trigramsOf(kw.first))
+                trigramIndex[g].push_back(id);
+        }
+    }
+
+    static const KeywordSpellChecker &instance()
+    {
+        static const KeywordSpellChecker checker;
+        return checker;
+    }
+
+    // Closest keyword within 1 edit (2 for words of 6+ letters), or nullptr
+    const Entry *closestKeyword(const string &word) const
+    {
+        if (word.size() < 3)
+            return nullptr;
+
+        uint8_t hits[256] = {};
+        for (uint32_t g : trigramsOf(word))
+        {
+            auto it = trigramIndex.find(g);
+            if (it == trigramIndex.end())
+                continue;
+            for (uint8_t id : it->second)
+                hits[id]++;
+        }
+
+        int maxDist = word.size() >= 6 ? 2 : 1;
+        const Entry *best = nullptr;
+        int bestDist = maxDist + 1;
+        int bestHits = 0;
+        for (size_t id = 0; id < entries.size(); id++)
+        {
+            const string &kw = entries[id].word;
+            if (hits[id] == 0 || kw == word ||
+                abs(int(kw.size()) - int(word.size())) > maxDist)
+                continue;
+
+            int dist = editDistance(word, kw);
+            if (dist < bestDist || (dist == bestDist && hits[id] > bestHits))
+            {
+                best = &entries[id];
+                bestDist = dist;
+                bestHits = hits[id];
+            }
+        }
+        return best;
+    }
+};
+
+// ============================================================================
+// SYMBOL TABLE MODULE
+// ============================================================================
+
+struct VarInfo
+{
+    string name, type;
+    uint32_t typeId;   // type, interned
+    int line, column;  // Track where variable was declared
+    int flowSlot = -1; // index in the enclosing function's dataflow sets, -1 if untracked
+    int64_t arrayLength = -1; // element count of a constant-size array, -1 if unknown
+    bool externDecl = false;  // extern declaration, not yet defined in this file
+    bool fileScope = false;   // global object, reported to the workspace index when referenced
+    VarInfo(string n = "", string t = "", int l = 0, int c = 0)
+        : name(n), type(t), typeId(StringInterner::current().intern(t)), line(l), column(c) {}
+};
+
+class TypeSystem
+{
+public:
+    // Check if two types are compatible
+    static bool isInteger(const string &t)
+    {
+        return t == "int" || t == "long" || t == "short";
+    }
+
+    static bool isFloat(const string &t)
+    {
+        return t == "float" || t == "double";
+    }
+
+    static bool isChar(const string &t)
+    {
+        return t == "char";
+    }
+
+    static bool isString(const string &t)
+    {
+        return t == "string";
+    }
+
+    static bool isPointer(const string &t)
+    {
         return t.size() > 1 && t.back() == '*';
     }
 
@@ -992,7 +1914,19 @@ public:
     // Get type of binary operation result
     static string getOperationResultType(const string &lhs, const string &rhs, const string &op)
     {
-        set<string> numericTypes = {"int", "float", "double", "char"};
+        static const set<string> numericTypes = {"int", "long", "short", "float", "double", "char"};
+
+        // Pointer arithmetic: p + n, n + p, p - n, p - q
+        if ((op == "+" || op == "-") && (isPointer(lhs) || isPointer(rhs)))
+        {
+            if (isPointer(lhs) && (isInteger(rhs) || isChar(rhs)))
+                return lhs;
+            if (op == "+" && isPointer(rhs) && (isInteger(lhs) || isChar(lhs)))
+                return rhs;
+            if (op == "-" && isPointer(lhs) && isPointer(rhs))
+                return "int";
+            return "INVALID";
+        }
 
         // Arithmetic operations
         if (op == "+" || op == "-" || op == "*" || op == "/")
@@ -1024,6 +1958,12 @@ public:
             if ((isNumericType(lhs) && isNumericType(rhs)))
                 return "int"; // Comparisons result in int (true/false)
 
+            // pointers compare with pointers and with null constants
+            if (isPointer(lhs) && (isPointer(rhs) || isInteger(rhs)))
+                return "int";
+            if (isPointer(rhs) && isInteger(lhs))
+                return "int";
+
             return "INVALID";
         }
 
@@ -1048,7 +1988,7 @@ public:
 
     static bool isNumericType(const string &type)
     {
-        set<string> numeric = {"int", "float", "double", "char"};
+        static const set<string> numeric = {"int", "long", "short", "float", "double", "char"};
         return numeric.count(type) > 0;
     }
 
@@ -1103,6 +2043,17 @@ public:
         return "UNKNOWN";
     }
 
+    VarInfo *lookup(const string &n)
+    {
+        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+        {
+            auto found = it->find(n);
+            if (found != it->end())
+                return &found->second;
+        }
+        return nullptr;
+    }
+
     bool exists(const string &n) const
     {
         if (stdLib.isStdioFunction(n) ||
@@ -1122,1753 +2073,6189 @@ public:
 };
 
 // ============================================================================
-// PARSER MODULE
+// DATAFLOW MODULE (control-flow graphs, definite assignment, liveness)
 // ============================================================================
 
-class Parser
+// Dense bitset over the tracked variables of one function
+class BitSet
 {
 private:
-    vector<Token> tokens;
-    size_t index; // current token index
-    SymbolTable sym;
-    vector<pair<string, string>> errors;
-    SuggestionEngine suggestionEngine;
-    StandardLibrary stdLib;
-    size_t lastIndex; // for backtracking
-    TypeSystem typeChecker;
-    int scopeDepth = 0; // Track current scope depth
+    vector<uint64_t> words;
 
-    Token curr() const { return index < tokens.size() ? tokens[index] : Token(TokenType::TOK_EOF, ""); }
-    Token peek(int offset = 1) const { return index + offset < tokens.size() ? tokens[index + offset] : Token(TokenType::TOK_EOF, ""); }
+public:
+    BitSet(size_t bits = 0, bool value = false) : words((bits + 63) / 64, value ? ~0ULL : 0ULL) {}
 
-    void advance()
+    void set(size_t i) { words[i >> 6] |= 1ULL << (i & 63); }
+    void reset(size_t i) { words[i >> 6] &= ~(1ULL << (i & 63)); }
+    bool test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    void unionWith(const BitSet &o)
     {
-        if (index < tokens.size())
-            index++;
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] |= o.words[i];
     }
 
-    void forceAdvance()
+    void intersectWith(const BitSet &o)
     {
-        if (index == lastIndex)
-        {
-            Token bad = curr();
-            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Skipping invalid token '" + bad.value + "'";
-            string sug = suggestionEngine.getSuggestion(errMsg);
-            errors.push_back({errMsg, sug});
-            advance();
-        }
-        lastIndex = index;
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] &= o.words[i];
     }
 
-    void expect(TokenType type, const string &desc)
+    void subtract(const BitSet &o)
     {
-        Token bad = curr();
-        if (bad.type != type)
-        {
-            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected '" + desc + "' but got '" + bad.value + "'";
-            string sug = suggestionEngine.getSuggestion(errMsg);
-            errors.push_back({errMsg, sug});
-        }
-        else
-        {
-            advance();
-        }
+        for (size_t i = 0; i < words.size(); i++)
+            words[i] &= ~o.words[i];
     }
 
-    bool isTypeToken(const Token &t) const
+    bool operator==(const BitSet &o) const { return words == o.words; }
+    bool operator!=(const BitSet &o) const { return words != o.words; }
+};
+
+struct FlowEvent
+{
+    enum Kind : uint8_t
     {
-        if (t.type == TokenType::KW_INT || t.type == TokenType::KW_FLOAT ||
-            t.type == TokenType::KW_CHAR || t.type == TokenType::KW_DOUBLE ||
-            t.type == TokenType::KW_VOID || t.type == TokenType::KW_STRUCT ||
-            t.type == TokenType::KW_AUTO)
-            return true;
+        USE,   // value is read
+        DEF,   // value is assigned
+        ESCAPE // address taken: may be read or written through a pointer
+    };
+    Kind kind;
+    bool isInit; // DEF from a declaration initializer
+    uint32_t var;
+    int line, column;
+};
 
-        // makes typedef names act like types
-        if (t.type == TokenType::TOK_IDENTIFIER)
-        {
-            string ty = sym.getType(t.value);
-            if (!ty.empty() && ty.rfind("typedef:", 0) == 0)
-                return true;
-        }
-        return false;
-    }
+struct FlowBlock
+{
+    vector<FlowEvent> events; // in evaluation order
+    vector<uint32_t> succs, preds;
+};
 
-    bool isComparisonOp(const Token &t)
+struct FlowVariable
+{
+    string name;
+    int line, column;
+    bool isParam;
+    bool unevaluatedUse; // named in a sizeof operand: used, but no dataflow event
+};
+
+// Per-function CFG built by the parser while it parses the body
+class FunctionFlowGraph
+{
+public:
+    static const uint32_t ENTRY = 0;
+    static const uint32_t EXIT = 1;
+
+    vector<FlowBlock> blocks;
+    vector<FlowVariable> vars;
+
+    FunctionFlowGraph() : blocks(2) {}
+
+    uint32_t newBlock()
     {
-        return t.type == TokenType::OP_LT || t.type == TokenType::OP_GT ||
-               t.type == TokenType::OP_LE || t.type == TokenType::OP_GE ||
-               t.type == TokenType::OP_EQ || t.type == TokenType::OP_NE;
+        blocks.emplace_back();
+        return blocks.size() - 1;
     }
 
-    bool isOp(const Token &t)
+    void addEdge(uint32_t from, uint32_t to)
     {
-        return t.type == TokenType::OP_PLUS || t.type == TokenType::OP_MINUS ||
-               t.type == TokenType::OP_STAR || t.type == TokenType::OP_SLASH ||
-               isComparisonOp(t) || t.type == TokenType::OP_ASSIGN;
+        blocks[from].succs.push_back(to);
+        blocks[to].preds.push_back(from);
     }
 
-    bool isValidUnaryOp(TokenType type)
+    uint32_t addVariable(const string &name, int line, int column, bool isParam)
     {
-        return type == TokenType::OP_MINUS || type == TokenType::OP_PLUS ||
-               type == TokenType::OP_NOT || type == TokenType::OP_BITNOT ||
-               type == TokenType::OP_INC || type == TokenType::OP_DEC;
+        vars.push_back({name, line, column, isParam, false});
+        return vars.size() - 1;
     }
 
-    bool isValidBinaryOp(TokenType type)
+    // Blocks reachable from ENTRY, in reverse postorder (iterative DFS)
+    vector<uint32_t> reversePostorder() const
     {
-        return type == TokenType::OP_PLUS || type == TokenType::OP_MINUS ||
-               type == TokenType::OP_STAR || type == TokenType::OP_SLASH ||
-               type == TokenType::OP_PERCENT || type == TokenType::OP_ASSIGN ||
-               type == TokenType::OP_EQ || type == TokenType::OP_NE ||
-               type == TokenType::OP_LT || type == TokenType::OP_GT ||
-               type == TokenType::OP_LE || type == TokenType::OP_GE ||
-               type == TokenType::OP_AND || type == TokenType::OP_OR ||
-               type == TokenType::OP_BITAND || type == TokenType::OP_BITOR ||
-               type == TokenType::OP_BITXOR;
+        vector<uint32_t> order;
+        vector<uint8_t> seen(blocks.size(), 0);
+        vector<pair<uint32_t, size_t>> stack = {{ENTRY, 0}};
+        seen[ENTRY] = 1;
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            const vector<uint32_t> &succs = blocks[top.first].succs;
+            if (top.second < succs.size())
+            {
+                uint32_t next = succs[top.second++];
+                if (!seen[next])
+                {
+                    seen[next] = 1;
+                    stack.push_back({next, 0});
+                }
+            }
+            else
+            {
+                order.push_back(top.first);
+                stack.pop_back();
+            }
+        }
+        reverse(order.begin(), order.end());
+        return order;
     }
+};
 
-    string parsePointerStars()
+// Iterative bitset dataflow over a FunctionFlowGraph. Blocks are revisited only when an
+// input changed, and a sweep visits them in reverse postorder (postorder for backward problems),
+// so acyclic code converges in one sweep and loops in (nesting depth + 2) sweeps.
+class DataflowSolver
+{
+private:
+    const FunctionFlowGraph &g;
+    vector<uint32_t> rpo;
+    size_t nvars;
+
+    template <typename Recompute>
+    void solve(const vector<uint32_t> &order, bool forward, Recompute recompute)
     {
-        string ptr = "";
-        while (curr().type == TokenType::OP_STAR)
+        vector<uint8_t> dirty(g.blocks.size(), 1);
+        bool changed = true;
+        while (changed)
         {
-            ptr += "*";
-            advance();
+            changed = false;
+            for (uint32_t b : order)
+            {
+                if (!dirty[b])
+                    continue;
+                dirty[b] = 0;
+                if (!recompute(b))
+                    continue;
+                changed = true;
+                for (uint32_t n : forward ? g.blocks[b].succs : g.blocks[b].preds)
+                    dirty[n] = 1;
+            }
         }
-        return ptr;
     }
 
-    string getExpressionType(const Token &t)
+public:
+    explicit DataflowSolver(const FunctionFlowGraph &graph)
+        : g(graph), rpo(graph.reversePostorder()), nvars(graph.vars.size()) {}
+
+    const vector<uint32_t> &order() const { return rpo; }
+
+    // Must-analysis: variables assigned on every path into each block
+    vector<BitSet> definitelyAssignedIn()
     {
-        if (t.type == TokenType::TOK_NUMBER)
-            return "int";
-        if (t.type == TokenType::TOK_STRING)
-            return "string";
-        if (t.type == TokenType::TOK_CHAR)
-            return "char";
-        if (t.type == TokenType::TOK_IDENTIFIER)
-            return sym.getType(t.value);
-        return "UNKNOWN";
+        size_t n = g.blocks.size();
+        vector<BitSet> in(n, BitSet(nvars, true)), out(n, BitSet(nvars, true)), gen(n, BitSet(nvars));
+        for (size_t b = 0; b < n; b++)
+            for (const FlowEvent &e : g.blocks[b].events)
+                if (e.kind != FlowEvent::USE)
+                    gen[b].set(e.var);
+        in[FunctionFlowGraph::ENTRY] = BitSet(nvars);
+
+        solve(rpo, true, [&](uint32_t b)
+              {
+                  BitSet newIn(nvars, b != FunctionFlowGraph::ENTRY);
+                  for (uint32_t p : g.blocks[b].preds)
+                      newIn.intersectWith(out[p]);
+                  in[b] = newIn;
+                  newIn.unionWith(gen[b]);
+                  if (newIn == out[b])
+                      return false;
+                  out[b] = newIn;
+                  return true; });
+        return in;
     }
 
-    string parseExpressionWithType()
+    // May-analysis: variables whose current value may still be read after each block
+    vector<BitSet> liveOut()
     {
-        string type = parsePrimaryWithType();
-        while (isOp(curr()))
+        size_t n = g.blocks.size();
+        vector<BitSet> in(n, BitSet(nvars)), out(n, BitSet(nvars)), use(n, BitSet(nvars)), def(n, BitSet(nvars));
+        for (size_t b = 0; b < n; b++)
         {
-            Token op = curr();
-            advance();
-            string rhsType = parsePrimaryWithType();
-
-            // Check type compatibility
-            if (type != "UNKNOWN" && rhsType != "UNKNOWN")
+            // walk backwards so a use before a def in the same block stays upward-exposed
+            const vector<FlowEvent> &events = g.blocks[b].events;
+            for (auto e = events.rbegin(); e != events.rend(); ++e)
             {
-                string resultType = TypeSystem::getOperationResultType(type, rhsType, op.value);
-
-                if (resultType == "INVALID")
+                if (e->kind == FlowEvent::DEF)
                 {
-                    string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
-                                    " - Type error: cannot apply '" + op.value + "' to '" + type +
-                                    "' and '" + rhsType + "'";
-                    string sug = "SUGGESTION: Ensure both operands are compatible types";
-                    errors.push_back({errMsg, sug});
+                    def[b].set(e->var);
+                    use[b].reset(e->var);
+                }
+                else
+                {
+                    use[b].set(e->var);
                 }
-                type = (resultType == "INVALID" || resultType == "UNKNOWN") ? type : resultType;
             }
         }
-        return type;
+
+        vector<uint32_t> postorder(rpo.rbegin(), rpo.rend());
+        solve(postorder, false, [&](uint32_t b)
+              {
+                  BitSet newOut(nvars);
+                  for (uint32_t s : g.blocks[b].succs)
+                      newOut.unionWith(in[s]);
+                  out[b] = newOut;
+                  newOut.subtract(def[b]);
+                  newOut.unionWith(use[b]);
+                  if (newOut == in[b])
+                      return false;
+                  in[b] = newOut;
+                  return true; });
+        return out;
     }
+};
 
-    void parseDeclOrFunc()
+// ============================================================================
+// FORMAT STRING MODULE (printf / scanf conversion specifiers)
+// ============================================================================
+
+struct FormatSpec
+{
+    size_t offset;     // position of '%' inside the literal token
+    string text;       // e.g. "%-5ld"
+    string length;     // run of length characters; valid ones are hh, h, l, ll, j, z, t, L
+    char conversion;   // d, s, f, ... or '\0' if the specifier is incomplete
+    int starArgs;      // printf: '*' width/precision each consume an int argument
+    bool suppressed;   // scanf: "%*d" reads but assigns nothing
+};
+
+class FormatStringParser
+{
+public:
+    // printf-style functions carry the format as their last fixed parameter
+    static bool isPrintfFamily(const string &fn) { return fn.size() >= 6 && fn.compare(fn.size() - 6, 6, "printf") == 0; }
+    static bool isScanfFamily(const string &fn) { return fn.size() >= 5 && fn.compare(fn.size() - 5, 5, "scanf") == 0; }
+
+    // literal is the token text including its quotes. memchr jumps straight to each '%'
+    // (libc implements it with SIMD), so plain text between specifiers costs almost nothing.
+    static vector<FormatSpec> parse(const string &literal, bool scanStyle)
     {
-        // start type
-        string typeName = curr().value;
-        advance();
+        vector<FormatSpec> specs;
+        const char *begin = literal.data();
+        const char *end = begin + literal.size();
+        const char *p = begin;
 
-        // SPECIAL: struct <Tag> as a type name or a definition
-        if (typeName == "struct")
+        while ((p = static_cast<const char *>(memchr(p, '%', end - p))) != nullptr)
         {
-            if (curr().type != TokenType::TOK_IDENTIFIER)
+            const char *start = p++;
+            if (p < end && *p == '%')
             {
-                Token bad = curr();
-                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected struct name";
-                errors.push_back({err, "SUGGESTION: struct <name> { ... } ; or struct <name> var;"});
-                advance();
-                return;
+                p++;
+                continue;
             }
-            string tag = curr().value;
-            Token tagTok = curr();
-            advance();
 
-            // struct <Tag> { ... }  → hand to parseStruct()
-            if (curr().type == TokenType::LBRACE)
+            FormatSpec spec{size_t(start - begin), "", "", '\0', 0, false};
+            if (scanStyle)
             {
-                // step back one token to let parseStruct() consume as if KW_STRUCT was just read
-                index -= 2; // back to 'struct'
-                return parseStruct();
+                if (p < end && *p == '*')
+                {
+                    spec.suppressed = true;
+                    p++;
+                }
+                while (p < end && isdigit((unsigned char)*p))
+                    p++;
+            }
+            else
+            {
+                while (p < end && strchr("-+ #0", *p))
+                    p++;
+                if (p < end && *p == '*')
+                {
+                    spec.starArgs++;
+                    p++;
+                }
+                while (p < end && isdigit((unsigned char)*p))
+                    p++;
+                if (p < end && *p == '.')
+                {
+                    p++;
+                    if (p < end && *p == '*')
+                    {
+                        spec.starArgs++;
+                        p++;
+                    }
+                    while (p < end && isdigit((unsigned char)*p))
+                        p++;
+                }
             }
 
-            // Otherwise it's a type name: "struct Tag"
-            typeName = "struct " + tag;
+            const char *lenStart = p;
+            while (p < end && *p && strchr("hljztL", *p))
+                p++;
+            spec.length.assign(lenStart, p);
+
+            if (p < end && *p != '"')
+            {
+                spec.conversion = *p++;
+                if (scanStyle && spec.conversion == '[')
+                {
+                    if (p < end && *p == ']')
+                        p++;
+                    while (p < end && *p != ']')
+                        p++;
+                    if (p < end)
+                        p++;
+                }
+            }
+            spec.text.assign(start, p);
+            specs.push_back(spec);
         }
+        return specs;
+    }
 
-        // handle pointer tokens after type (int **p)
-        typeName += parsePointerStars();
-
-        if (curr().type != TokenType::TOK_IDENTIFIER)
-        {
-            Token bad = curr();
-            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected identifier";
-            errors.push_back({err, suggestionEngine.getSuggestion(err)});
-            advance();
-            return;
-        }
-
-        Token nameTok = curr();
-        string ident = nameTok.value;
-        advance();
-
-        if (curr().type == TokenType::LPAREN)
-            parseFunction(typeName, ident, nameTok);
-        else
-            parseVarDecl(typeName, ident, nameTok);
+    static bool validLength(const string &length)
+    {
+        return length.empty() || length == "hh" || length == "ll" ||
+               (length.size() == 1 && strchr("hljztL", length[0]));
     }
 
-    void parseVarDecl(const string &type, const string &ident, const Token &nameTok)
+    // Type the argument for spec should have, in the engine's type vocabulary ("" = unknown conversion)
+    static string expectedType(const FormatSpec &spec, bool scanStyle)
     {
-        string declaredType = type; // Already includes pointers from parseStatement
+        char c = spec.conversion;
+        bool isLong = spec.length == "l" || spec.length == "ll" || spec.length == "L";
+        if (c && strchr("diouxX", c))
+            return scanStyle ? "int*" : "int";
+        if (c && strchr("fFeEgGaA", c))
+            return scanStyle ? (isLong ? "double*" : "float*") : "double";
+        if (c == 'c')
+            return scanStyle ? "char*" : "int";
+        if (c == 's' || (scanStyle && c == '['))
+            return "char*";
+        if (c == 'p')
+            return scanStyle ? "void**" : "void*";
+        if (c == 'n')
+            return "int*";
+        return "";
+    }
 
-        // Handle leading pointer tokens before variable name (int *p)
-        declaredType += parsePointerStars();
+    // Would a value of argType be accepted where the specifier expects `expected`?
+    static bool argumentMatches(const string &expected, const string &argType)
+    {
+        string arg = argType;
+        if (arg == "string")
+            arg = "char*";
+        else if (arg.size() > 2 && arg.compare(arg.size() - 2, 2, "[]") == 0)
+            arg = arg.substr(0, arg.size() - 2) + "*";
+        arg = FunctionSignature::normalizeType(arg);
+
+        if (expected == "int")
+            return TypeSystem::isInteger(arg) || TypeSystem::isChar(arg);
+        if (expected == "double")
+            return TypeSystem::isFloat(arg);
+        if (expected == "void*" || expected == "void**")
+            return TypeSystem::isPointer(arg);
+        if (expected == "int*")
+            return TypeSystem::isPointer(arg) &&
+                   (TypeSystem::isInteger(TypeSystem::basePointerType(arg)) ||
+                    TypeSystem::isChar(TypeSystem::basePointerType(arg)));
+        return arg == expected; // float* vs double* must match exactly for scanf
+    }
+};
 
-        bool isArray = false;
-        string arraySize = "";
+// ============================================================================
+// RULE MODULE (pluggable checks dispatched from one walk of the tokens)
+// ============================================================================
 
-        // Check for array declarator
-        if (curr().type == TokenType::LBRACKET)
-        {
-            isArray = true;
-            advance();
+// Syntactic constructs the parser reports to rules as it recognizes them
+enum class NodeKind : uint8_t
+{
+    FunctionBegin, // name = function, type = return type
+    FunctionEnd,   // anchored at the closing '}'
+    VarDecl,       // name = variable, type = declared type
+    Call,          // name = callee, count = argument count
+    Loop,          // name = "while" / "for", range covers the body
+    Condition,     // name = "if" / "while" / "for", range is inside the parentheses
+    Return,
+    Parameter,     // struct passed by value to a function definition: count = size in bytes (-1 unknown)
+    COUNT
+};
 
-            if (curr().type == TokenType::TOK_NUMBER)
-            {
-                arraySize = curr().value;
-                advance();
-            }
+struct RuleNode
+{
+    NodeKind kind;
+    size_t at;          // token index the node is dispatched at
+    size_t first, last; // token range [first, last)
+    string name, type;
+    int count = 0;
+};
 
-            expect(TokenType::RBRACKET, "]");
-            declaredType += "[]";
-        }
+class RuleContext
+{
+private:
+    const vector<Token> &toks;
+    vector<pair<string, string>> &diagnostics;
 
-        if (!sym.declare(ident, declaredType, nameTok.line, nameTok.column))
-        {
-            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
-                            " - Redeclaration of '" + ident + "'";
-            string sug = suggestionEngine.getSuggestion(errMsg);
-            errors.push_back({errMsg, sug});
-        }
+public:
+    RuleContext(const vector<Token> &t, vector<pair<string, string>> &out) : toks(t), diagnostics(out) {}
 
-        if (curr().type == TokenType::OP_ASSIGN)
-        {
-            Token assignTok = curr();
-            advance();
+    const vector<Token> &tokens() const { return toks; }
 
-            if (isArray && curr().type == TokenType::LBRACE)
-            {
-                advance();
-                int elementCount = 0;
-                if (curr().type != TokenType::RBRACE)
-                {
-                    while (true)
-                    {
-                        parseExpression();
-                        elementCount++;
-                        if (curr().type == TokenType::COMMA)
-                            advance();
-                        else
-                            break;
-                    }
-                }
-                expect(TokenType::RBRACE, "}");
-                if (!arraySize.empty() && stoi(arraySize) < elementCount)
-                {
-                    string errMsg = "Line " + to_string(assignTok.line) + ":" + to_string(assignTok.column) +
-                                    " - Array size mismatch: declared " + arraySize +
-                                    " but initialized with " + to_string(elementCount) + " elements";
-                    string sug = "SUGGESTION: Increase array size or reduce initializer elements";
-                    errors.push_back({errMsg, sug});
-                }
-            }
+    void warn(const Token &at, const string &message, const string &suggestion)
+    {
+        diagnostics.push_back({"Warning: Line " + to_string(at.line) + ":" + to_string(at.column) + " - " + message,
+                               suggestion});
+    }
+};
 
-            else
-            {
-                string rhsType = parseExpressionWithFullType();
+// A rule subscribes to token and node kinds; the engine only calls it for those
+class Rule
+{
+public:
+    virtual ~Rule() {}
+    virtual string name() const = 0;
+    virtual vector<TokenType> tokenKinds() const { return {}; }
+    virtual vector<NodeKind> nodeKinds() const { return {}; }
+
+    virtual void begin(RuleContext &) {} // per translation unit
+    virtual void onToken(RuleContext &, size_t) {}
+    virtual void onNode(RuleContext &, const RuleNode &) {}
+    virtual void finish(RuleContext &) {}
+};
 
-                if (rhsType != "UNKNOWN" && !TypeSystem::areTypesCompatible(declaredType, rhsType))
-                {
-                    string errMsg = "Warning: Line " + to_string(assignTok.line) + ":" + to_string(assignTok.column) +
-                                    " - Type mismatch: assigning '" + rhsType + "' to '" + declaredType + "'";
-                    string sug = "SUGGESTION: Types must be compatible";
-                    errors.push_back({errMsg, sug});
-                }
-            }
+class RuleEngine
+{
+private:
+    static const size_t TOKEN_KINDS = (size_t)TokenType::TOK_UNKNOWN + 1;
+    static const size_t NODE_KINDS = (size_t)NodeKind::COUNT;
+
+    vector<unique_ptr<Rule>> rules;
+    vector<bool> enabled;
+    vector<uint16_t> tokenTable[TOKEN_KINDS]; // kind -> subscribed enabled rule indices
+    vector<uint16_t> nodeTable[NODE_KINDS];
+    bool profiling = false;
+    vector<RuleTiming> timings;
+
+    template <typename F>
+    void dispatch(uint16_t r, F &&call)
+    {
+        if (!profiling)
+        {
+            call(*rules[r]);
+            return;
         }
+        auto start = chrono::steady_clock::now();
+        call(*rules[r]);
+        timings[r].milliseconds += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        timings[r].calls++;
+    }
 
-        // Handle multiple declarations: int *p, **q, arr[5];
-        // REPLACE the "while (curr().type == TokenType::COMMA) { ... }" in parseVarDecl with:
-        while (curr().type == TokenType::COMMA)
-        {
-            advance();
+    void subscribe(uint16_t id)
+    {
+        for (TokenType k : rules[id]->tokenKinds())
+            tokenTable[(size_t)k].push_back(id);
+        for (NodeKind k : rules[id]->nodeKinds())
+            nodeTable[(size_t)k].push_back(id);
+    }
 
-            // collect any pointer stars BEFORE the next identifier
-            string nextDeclaredType = type; // base type for next variable eg: int a, b;
+public:
+    void addRule(unique_ptr<Rule> rule)
+    {
+        uint16_t id = (uint16_t)rules.size();
+        timings.push_back({rule->name(), 0, 0});
+        rules.push_back(move(rule));
+        enabled.push_back(true);
+        subscribe(id);
+    }
 
-            nextDeclaredType += parsePointerStars();
+    // Disabled rules are left out of the dispatch tables, so they cost nothing
+    bool setEnabled(const string &name, bool on)
+    {
+        bool found = false;
+        for (size_t r = 0; r < rules.size(); r++)
+            if (rules[r]->name() == name)
+                enabled[r] = on, found = true;
+        if (!found)
+            return false;
 
-            if (curr().type != TokenType::TOK_IDENTIFIER)
-            {
-                Token bad = curr();
-                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected identifier";
-                errors.push_back({err, "SUGGESTION: Provide a variable name after ',' (example: int *a, **b;)"});
-                break;
-            }
+        for (auto &table : tokenTable)
+            table.clear();
+        for (auto &table : nodeTable)
+            table.clear();
+        for (uint16_t r = 0; r < rules.size(); r++)
+            if (enabled[r])
+                subscribe(r);
+        return true;
+    }
 
-            Token t = curr(); // the identifier
-            advance();
+    void setProfiling(bool on) { profiling = on; }
 
-            // optional array declarator: int *a, **b[10]
-            if (curr().type == TokenType::LBRACKET)
-            {
-                advance();
-                if (curr().type == TokenType::TOK_NUMBER)
-                    advance();
-                expect(TokenType::RBRACKET, "]");
-                nextDeclaredType += "[]";
-            }
+    // Time spent in each rule during the last run()
+    const vector<RuleTiming> &getTimings() const { return timings; }
 
-            if (!sym.declare(t.value, nextDeclaredType, t.line, t.column))
-            {
-                string err = "Line " + to_string(t.line) + ":" + to_string(t.column) +
-                             " - Redeclaration of '" + t.value + "'";
-                errors.push_back({err, suggestionEngine.getSuggestion(err)});
-            }
+    // Nodes are dispatched before the token they are anchored at; tokens
+    // before first (header code) are context only
+    void run(const vector<Token> &tokens, vector<RuleNode> nodes, vector<pair<string, string>> &out, size_t first = 0)
+    {
+        for (RuleTiming &t : timings)
+            t.milliseconds = 0, t.calls = 0;
 
-            if (curr().type == TokenType::OP_ASSIGN)
-            {
-                advance();
-                string rhsType = parseExpressionWithFullType();
+        RuleContext ctx(tokens, out);
+        stable_sort(nodes.begin(), nodes.end(), [](const RuleNode &a, const RuleNode &b)
+                    { return a.at < b.at; });
 
-                if (rhsType != "UNKNOWN" && !TypeSystem::areTypesCompatible(nextDeclaredType, rhsType))
-                {
-                    errors.push_back({"Warning: Line " + to_string(t.line) + ":" + to_string(t.column) + " - Type mismatch",
-                                      "SUGGESTION: Types must match"});
-                }
-            }
+        for (uint16_t r = 0; r < rules.size(); r++)
+            if (enabled[r])
+                dispatch(r, [&](Rule &rule)
+                         { rule.begin(ctx); });
+
+        size_t n = 0;
+        for (size_t i = first; i <= tokens.size(); i++)
+        {
+            for (; n < nodes.size() && (nodes[n].at <= i || i == tokens.size()); n++)
+                for (uint16_t r : nodeTable[(size_t)nodes[n].kind])
+                    dispatch(r, [&](Rule &rule)
+                             { rule.onNode(ctx, nodes[n]); });
+
+            if (i < tokens.size())
+                for (uint16_t r : tokenTable[(size_t)tokens[i].type])
+                    dispatch(r, [&](Rule &rule)
+                             { rule.onToken(ctx, i); });
         }
 
-        expect(TokenType::SEMICOLON, ";");
+        for (uint16_t r = 0; r < rules.size(); r++)
+            if (enabled[r])
+                dispatch(r, [&](Rule &rule)
+                         { rule.finish(ctx); });
     }
+};
+
+// ----------------------------------------------------------------------------
+// Built-in rules
+// ----------------------------------------------------------------------------
+
+// gets() cannot be used safely; strcpy/strcat/sprintf have no bound
+class UnsafeFunctionRule : public Rule
+{
+public:
+    string name() const override { return "unsafe-function"; }
+    vector<NodeKind> nodeKinds() const override { return {NodeKind::Call}; }
 
-    void parseFunction(const std::string & /*type*/, const std::string &ident, const Token &nameTok)
+    void onNode(RuleContext &ctx, const RuleNode &node) override
     {
-        // Reject nested functions
-        if (scopeDepth > 0)
-        {
-            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
-                            " - Invalid: nested function declaration '" + ident + "'";
-            string sug = "SUGGESTION: C does not support nested functions. Move to file scope";
-            errors.push_back({errMsg, sug});
+        static const unordered_map<string, string> replacements = {
+            {"gets", "fgets(buf, sizeof buf, stdin)"},
+            {"strcpy", "strncpy or snprintf with the destination size"},
+            {"strcat", "strncat with the remaining space"},
+            {"sprintf", "snprintf(buf, sizeof buf, ...)"}};
+
+        auto it = replacements.find(node.name);
+        if (it != replacements.end())
+            ctx.warn(ctx.tokens()[node.first], "Call to '" + node.name + "' can overflow its destination buffer",
+                     "SUGGESTION: Use " + it->second);
+    }
+};
 
-            while (curr().type != TokenType::LBRACE && curr().type != TokenType::SEMICOLON &&
-                   curr().type != TokenType::TOK_EOF)
-            {
-                advance();
-            }
-            if (curr().type == TokenType::SEMICOLON)
-            {
-                advance();
-            }
+// if (x = 5) is almost always a typo for ==; extra parentheses mark intent
+class AssignmentInConditionRule : public Rule
+{
+public:
+    string name() const override { return "assignment-in-condition"; }
+    vector<NodeKind> nodeKinds() const override { return {NodeKind::Condition}; }
 
-            else if (curr().type == TokenType::LBRACE)
+    void onNode(RuleContext &ctx, const RuleNode &node) override
+    {
+        int depth = 0;
+        for (size_t i = node.first; i < node.last; i++)
+        {
+            const Token &t = ctx.tokens()[i];
+            if (t.type == TokenType::LPAREN)
+                depth++;
+            else if (t.type == TokenType::RPAREN)
+                depth--;
+            else if (t.type == TokenType::OP_ASSIGN && depth == 0)
             {
-                int braceCount = 1;
-                advance();
-                while (braceCount > 0 && curr().type != TokenType::TOK_EOF) // to skip the block entirely
-                {
-                    if (curr().type == TokenType::LBRACE)
-                        braceCount++;
-                    if (curr().type == TokenType::RBRACE)
-                        braceCount--;
-                    advance();
-                }
+                ctx.warn(t, "Assignment used as the condition of '" + node.name + "'",
+                         "SUGGESTION: Use '==' to compare, or wrap the assignment in extra parentheses if intended");
+                return;
             }
-            return;
         }
+    }
+};
 
-        // Detect function redeclaration
-        if (sym.exists(ident) && sym.getType(ident) == "function")
-        {
-            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
-                            " - Redeclaration of function '" + ident + "'";
-            string sug = "SUGGESTION: Function '" + ident + "' is already declared";
-            errors.push_back({errMsg, sug});
-        }
+// 010 is eight, not ten
+class OctalLiteralRule : public Rule
+{
+public:
+    string name() const override { return "octal-literal"; }
+    vector<TokenType> tokenKinds() const override { return {TokenType::TOK_NUMBER}; }
 
-        sym.declare(ident, "function");
-        advance();
-        sym.pushScope();
-        scopeDepth++;
+    void onToken(RuleContext &ctx, size_t i) override
+    {
+        const string &v = ctx.tokens()[i].value;
+        if (ctx.tokens()[i].numFlags & NUM_OCTAL)
+            ctx.warn(ctx.tokens()[i], "Literal '" + v + "' is octal (leading zero)",
+                     "SUGGESTION: Drop the leading zero for a decimal value, or write it in hex");
+    }
+};
 
-        // Parse parameters
-        if (curr().type != TokenType::RPAREN)
-        {
-            while (true)
-            {
-                if (!isTypeToken(curr()))
-                {
-                    Token bad = curr();
-                    string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                    " - Expected type";
-                    string sug = suggestionEngine.getSuggestion(errMsg);
-                    errors.push_back({errMsg, sug});
-                    break;
-                }
+// ----------------------------------------------------------------------------
+// Performance rules
+// ----------------------------------------------------------------------------
 
-                string pType = curr().value;
-                advance();
+// strlen() walks the whole string, so in a loop condition it makes the loop quadratic
+class StrlenInLoopConditionRule : public Rule
+{
+public:
+    string name() const override { return "strlen-in-loop-condition"; }
+    vector<NodeKind> nodeKinds() const override { return {NodeKind::Condition}; }
 
-                pType += parsePointerStars();
+    void onNode(RuleContext &ctx, const RuleNode &node) override
+    {
+        if (node.name == "if")
+            return;
+        const vector<Token> &t = ctx.tokens();
+        for (size_t i = node.first; i + 1 < node.last; i++)
+            if (t[i].type == TokenType::TOK_IDENTIFIER && t[i].value == "strlen" && t[i + 1].type == TokenType::LPAREN)
+                ctx.warn(t[i], "Call to 'strlen' in the loop condition rescans the string on every iteration",
+                         "SUGGESTION: Compute the length once before the loop, or test for the terminating '\\0'");
+    }
+};
 
-                if (curr().type != TokenType::TOK_IDENTIFIER)
-                {
-                    Token bad = curr();
-                    string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                    " - Expected parameter name";
-                    string sug = suggestionEngine.getSuggestion(errMsg);
-                    errors.push_back({errMsg, sug});
-                    break;
-                }
+// Base for rules about calls made inside loop bodies. Loop nodes are anchored
+// at the loop keyword and cover the whole loop, so they arrive before the
+// calls they contain; a loop ends when a node past its range arrives.
+class LoopCallRule : public Rule
+{
+protected:
+    vector<size_t> loopEnds; // innermost last
 
-                sym.declare(curr().value, pType);
-                advance();
+    virtual void onLoopEnd() {}
 
-                if (curr().type == TokenType::COMMA)
-                    advance();
-                else
-                    break;
-            }
+    void leaveLoops(size_t at)
+    {
+        while (!loopEnds.empty() && loopEnds.back() <= at)
+        {
+            onLoopEnd();
+            loopEnds.pop_back();
         }
+    }
 
-        expect(TokenType::RPAREN, ")");
+public:
+    vector<NodeKind> nodeKinds() const override { return {NodeKind::Loop, NodeKind::Call}; }
 
-        if (curr().type == TokenType::SEMICOLON)
-        {
-            advance();
-            scopeDepth--;
-            sym.popScope();
-            return;
-        }
+    void begin(RuleContext &) override { loopEnds.clear(); }
 
-        expect(TokenType::LBRACE, "{");
-        parseBlock();
-        scopeDepth--;
-        sym.popScope();
+    void onNode(RuleContext &ctx, const RuleNode &node) override
+    {
+        leaveLoops(node.at);
+        if (node.kind == NodeKind::Loop)
+            loopEnds.push_back(node.last);
+        else if (!loopEnds.empty())
+            onCallInLoop(ctx, node);
     }
 
-    void parseBlock()
-    {
-        int maxIter = 10000;
-        int iter = 0;
-        while (curr().type != TokenType::RBRACE && curr().type != TokenType::TOK_EOF && iter++ < maxIter)
-        {
-            lastIndex = index;
-            if (isTypeToken(curr()))
-                parseDeclOrFunc();
-            else
-                parseStatement();
-            forceAdvance();
-        }
+    virtual void onCallInLoop(RuleContext &ctx, const RuleNode &call) = 0;
 
-        if (iter >= maxIter)
-        {
-            Token bad = curr();
-            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Parser stuck, aborting block";
-            errors.push_back({errMsg, ""});
-        }
-        expect(TokenType::RBRACE, "}");
+    void finish(RuleContext &) override { leaveLoops(SIZE_MAX); }
+};
+
+// strcat() finds the end of the destination first: appending n times costs O(n^2)
+class StrcatInLoopRule : public LoopCallRule
+{
+public:
+    string name() const override { return "strcat-in-loop"; }
+
+    void onCallInLoop(RuleContext &ctx, const RuleNode &call) override
+    {
+        if (call.name == "strcat" || call.name == "strncat")
+            ctx.warn(ctx.tokens()[call.first],
+                     "Call to '" + call.name + "' inside a loop rescans the destination each time (quadratic)",
+                     "SUGGESTION: Keep a pointer to the end of the string and append there");
     }
+};
 
-    // factor typedef into a reusable routine
-    void parseTypedef()
+// malloc and free in the same loop body: the allocator runs on every iteration
+class AllocationInLoopRule : public LoopCallRule
+{
+private:
+    struct LoopCalls
     {
-        advance(); // consumed KW_TYPEDEF
+        const Token *alloc = nullptr;
+        string allocName;
+        bool frees = false;
+    };
+    vector<LoopCalls> calls; // parallel to loopEnds, filled lazily
+    RuleContext *context = nullptr;
+
+    LoopCalls &innermost()
+    {
+        calls.resize(loopEnds.size());
+        return calls.back();
+    }
 
-        if (!isTypeToken(curr()))
-        {
-            Token bad = curr();
-            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                         " - Expected type after typedef";
-            errors.push_back({err, "SUGGESTION: typedef <existing_type> <new_name>;"});
-            return;
-        }
+protected:
+    void onLoopEnd() override
+    {
+        LoopCalls &c = innermost();
+        if (c.alloc && c.frees)
+            context->warn(*c.alloc,
+                          "'" + c.allocName + "' and 'free' in the same loop allocate and release memory on every iteration",
+                          "SUGGESTION: Allocate the buffer once before the loop and reuse it");
+        calls.pop_back();
+    }
 
-        string baseType = curr().value;
-        advance();
+public:
+    string name() const override { return "allocation-in-loop"; }
 
-        // typedef struct Point ...
-        if (baseType == "struct")
-        {
-            if (curr().type == TokenType::TOK_IDENTIFIER)
-            {
-                baseType += " " + curr().value;
-                advance();
-            }
-        }
+    void begin(RuleContext &ctx) override
+    {
+        LoopCallRule::begin(ctx);
+        calls.clear();
+        context = &ctx;
+    }
 
-        baseType += parsePointerStars();
+    void onCallInLoop(RuleContext &ctx, const RuleNode &call) override
+    {
+        LoopCalls &c = innermost();
+        if (call.name == "free")
+            c.frees = true;
+        else if (!c.alloc && (call.name == "malloc" || call.name == "calloc"))
+            c.alloc = &ctx.tokens()[call.first], c.allocName = call.name;
+    }
+};
 
-        if (curr().type != TokenType::TOK_IDENTIFIER)
-        {
-            Token bad = curr();
-            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                         " - Expected new type name in typedef";
-            errors.push_back({err, "SUGGESTION: Provide name for the new type"});
-            return;
-        }
+// Passing a struct by value copies all of it on every call
+class LargeStructByValueRule : public Rule
+{
+private:
+    int limit;
 
-        string newTypeName = curr().value;
-        advance();
-        expect(TokenType::SEMICOLON, ";");
+public:
+    explicit LargeStructByValueRule(int bytes = 64) : limit(bytes) {}
+
+    string name() const override { return "large-struct-by-value"; }
+    vector<NodeKind> nodeKinds() const override { return {NodeKind::Parameter}; }
 
-        // Mark clearly as a typedef so we can recognize it as a type later
-        sym.declare(newTypeName, "typedef:" + baseType);
+    void onNode(RuleContext &ctx, const RuleNode &node) override
+    {
+        if (node.count > limit)
+            ctx.warn(ctx.tokens()[node.at],
+                     "Parameter '" + node.name + "' copies " + node.type + " (" + to_string(node.count) +
+                         " bytes) on every call",
+                     "SUGGESTION: Pass a pointer instead (const " + node.type + " * if it is not modified)");
     }
+};
 
-    // factor struct into a reusable routine
-    void parseStruct()
+// ============================================================================
+// TARGET ABI MODULE (scalar sizes and alignments for struct layout)
+// ============================================================================
+
+enum class TargetABI
+{
+    SysV_x86_64, // Linux, macOS, BSD on x86-64 (LP64)
+    SysV_i386,   // 32-bit x86: pointers are 4 bytes, double is 4-aligned
+    Win64        // LLP64: differs from LP64 only in long, which the parser has no keyword for
+};
+
+struct ABILayout
+{
+    struct Scalar
     {
-        advance(); // consumed KW_STRUCT
+        const char *type; // "*" stands for every pointer
+        int64_t size, align;
+    };
+    array<Scalar, 5> scalars; // the scalar types a struct member can have
+    int64_t cacheLine;
 
-        if (curr().type != TokenType::TOK_IDENTIFIER)
+    bool find(const string &type, int64_t &size, int64_t &align) const
+    {
+        for (const Scalar &s : scalars)
+            if (type == s.type)
+            {
+                size = s.size, align = s.align;
+                return true;
+            }
+        return false;
+    }
+
+    static const ABILayout &of(TargetABI abi)
+    {
+        static const ABILayout sysv64{{{{"char", 1, 1}, {"int", 4, 4}, {"float", 4, 4}, {"double", 8, 8}, {"*", 8, 8}}},
+                                      64};
+        static const ABILayout sysv32{{{{"char", 1, 1}, {"int", 4, 4}, {"float", 4, 4}, {"double", 8, 4}, {"*", 4, 4}}},
+                                      64};
+        static const ABILayout win64{{{{"char", 1, 1}, {"int", 4, 4}, {"float", 4, 4}, {"double", 8, 8}, {"*", 8, 8}}},
+                                     64};
+        switch (abi)
         {
-            Token bad = curr();
-            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                         " - Expected struct name";
-            errors.push_back({err, "SUGGESTION: struct <name> { ... } or struct <name> <variable>;"});
-            return;
+        case TargetABI::SysV_i386:
+            return sysv32;
+        case TargetABI::Win64:
+            return win64;
+        default:
+            return sysv64;
         }
+    }
+};
 
-        string structName = curr().value;
-        advance();
+// ============================================================================
+// PARSER MODULE
+// ============================================================================
 
-        // struct <name> { ... } [opt var] ;
-        if (curr().type == TokenType::LBRACE)
-        {
-            advance();
-            while (curr().type != TokenType::RBRACE && curr().type != TokenType::TOK_EOF)
-            {
-                if (isTypeToken(curr()))
-                {
-                    string memberType = curr().value;
-                    advance();
+// A call or function reference seen by the parser
+struct CallEdge
+{
+    int32_t caller;  // index into the file's function metrics, -1 at file scope
+    uint32_t callee; // interned name
+};
 
-                    memberType += parsePointerStars();
+// A declaration or definition with external linkage, for the cross-file checks
+struct ExternalSymbol
+{
+    uint32_t name; // interned
+    uint32_t type; // interned object type, or function signature "int(char*,...)"
+    int line, column;
+    bool definition; // a function body, an initializer, or a tentative "int x;"
+};
 
-                    if (curr().type == TokenType::TOK_IDENTIFIER)
-                    {
-                        advance();
-                        expect(TokenType::SEMICOLON, ";");
-                    }
-                    else
-                    {
-                        Token bad = curr();
-                        string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                     " - Expected member name in struct";
-                        errors.push_back({err, ""});
-                        advance();
-                    }
-                }
-                else
-                {
-                    Token bad = curr();
-                    string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                 " - Expected type in struct member";
-                    errors.push_back({err, ""});
-                    advance();
-                }
-            }
-            expect(TokenType::RBRACE, "}");
+// What one file contributes to the whole-program checks; small next to the
+// file itself, so a batch keeps only these between the per-file passes
+struct UnitSummary
+{
+    vector<CallEdge> calls;
+    vector<ExternalSymbol> externals;
+    vector<uint32_t> references; // interned names of global objects read or written
+    vector<uint32_t> staticFunctions; // indices into the file's function metrics with internal linkage
+    vector<uint32_t> staticObjects;   // interned names of file-scope objects with internal linkage
+};
 
-            // Either just a definition ...
-            if (curr().type == TokenType::SEMICOLON)
-            {
-                advance();
-            }
-            // ... or an inline variable: struct N { ... } v;
-            else if (curr().type == TokenType::TOK_IDENTIFIER || curr().type == TokenType::OP_STAR)
-            {
-                // allow pointer before name: struct N {..} *p;
-                string varType = "struct " + structName;
+// Check policies: each flag compiles a family of semantic checks in or out of
+// the parser instantiation (syntax errors are always reported)
+struct FullChecks
+{
+    static constexpr bool nameChecks = true;   // undeclared identifiers
+    static constexpr bool typeChecks = true;   // assignment/initializer/operator type errors
+    static constexpr bool lvalueChecks = true; // ++/-- on non-modifiable operands
+    static constexpr bool callChecks = true;   // signatures, call arguments, format strings
+    static constexpr bool flowChecks = true;   // uninitialized / unused variables
+    static constexpr bool layoutChecks = true; // struct padding and cache-line straddling
+};
 
-                varType += parsePointerStars();
+struct SyntaxOnlyChecks
+{
+    static constexpr bool nameChecks = false;
+    static constexpr bool typeChecks = false;
+    static constexpr bool lvalueChecks = false;
+    static constexpr bool callChecks = false;
+    static constexpr bool flowChecks = false;
+    static constexpr bool layoutChecks = false;
+};
 
-                Token nameTok = curr();
-                if (nameTok.type == TokenType::TOK_IDENTIFIER)
-                {
-                    advance();
-                    parseVarDecl(varType, nameTok.value, nameTok);
-                    return;
-                }
-                else
-                {
-                    string err = "Line " + to_string(curr().line) + ":" + to_string(curr().column) +
-                                 " - Expected variable name after struct definition";
-                    errors.push_back({err, "SUGGESTION: struct " + structName + " { ... } var;"});
-                }
-            }
-            else
-            {
-                string err = "Line " + to_string(curr().line) + ":" + to_string(curr().column) +
-                             " - Expected ';' or variable after struct definition";
-                errors.push_back({err, "SUGGESTION: struct " + structName + " { ... }; or struct " + structName + " var;"});
-            }
+template <typename Policy>
+class ParserT
+{
+private:
+    vector<Token> tokens;
+    size_t index; // current token index
+    SymbolTable sym;
+    vector<pair<string, string>> errors;
+    SuggestionEngine suggestionEngine;
+    StandardLibrary stdLib;
+    size_t lastIndex; // for backtracking
+    TypeSystem typeChecker;
+    int scopeDepth = 0; // Track current scope depth
+    SignatureTable userSignatures;               // functions declared or defined in this file
+    FunctionFlowGraph *flow = nullptr;           // CFG of the function body being parsed
+    uint32_t flowBlock = 0;                      // basic block that receives new flow events
+    vector<pair<uint32_t, uint32_t>> loopTargets; // (continue target, break target) per enclosing loop
+    vector<FunctionMetrics> functionMetrics;     // finished function definitions
+    FunctionMetrics *metrics = nullptr;          // function body being parsed
+    int nestingDepth = 0;                        // if/loop nesting inside the current body
+    unordered_map<uint64_t, bool> argCompatCache; // (param type id, arg type id) -> compatible
+
+    // Expression types travel as interned spellings; the common ones
+    const uint32_t unknownType = typeId("UNKNOWN");
+    const uint32_t functionType = typeId("function");
+    const uint32_t intType = typeId("int");
+    const uint32_t longType = typeId("long");
+    const uint32_t floatType = typeId("float");
+    const uint32_t doubleType = typeId("double");
+    const uint32_t charType = typeId("char");
+    const uint32_t stringType = typeId("string");
+    vector<RuleNode> ruleNodes;                   // constructs recognized so far, for the rule engine
+    unordered_map<string, unordered_map<string, string>> structMembers; // "struct P" -> member -> type
+
+    struct StructField
+    {
+        Token name;
+        string type;    // "int[]" for arrays
+        int64_t length; // array element count, -1 if unknown
+    };
+    unordered_map<string, vector<StructField>> structFields; // "struct P" -> members in declaration order
+    unordered_map<string, StructLayout> layouts;             // memo; size -1 while in progress or unknown
+    const ABILayout *abi = &ABILayout::of(TargetABI::SysV_x86_64);
+    vector<StructLayout> definedLayouts;                     // structs defined in this file
+    vector<int32_t> typeNameMemo;                 // typeNameEnd() per token index, -1 = not probed yet
+    int unevaluated = 0;                          // inside sizeof: no dataflow events
+    bool derefOperand = false;                    // next primary is the operand of unary '*'
+    unordered_map<string, string> typedefs;       // typedef name -> underlying type, innermost binding
+    vector<pair<string, string>> typedefUndo;     // (name, binding it replaced or "") per typedef change
+    vector<size_t> typedefMarks;                  // typedefUndo size when each open block scope began
+    size_t classifiedEnd = 0;                     // tokens before this carry their TYPEDEF_NAME tag
+
+    struct MacroConstant
+    {
+        vector<Token> body;
+        enum State : uint8_t
+        {
+            Pending,
+            Evaluating,
+            Done,
+            NotConstant
+        } state = Pending;
+        int64_t value = 0;
+        pair<string, string> fault; // why a NotConstant body failed, if it divided by zero or so
+    };
+    unordered_map<string, MacroConstant> macros;  // object-like #define bodies, folded on first use
+    pair<string, string> constFault;              // division by zero or bad shift met by the current fold
+    int unevaluatedFold = 0;                      // > 0 inside '?:' arms and '&&'/'||' operands C skips
+    bool foldUsesScope = false;                   // the current fold looked up a variable or typedef
+    unordered_map<string, int64_t> enumConstants; // enumerator values
+    vector<size_t> headerEnds;                    // where each #included header's tokens end; all precede the file's
+    size_t unitEnd;                               // end of the header or file being parsed; curr() is EOF there
+    PreprocessorHandler preprocessor;             // standard headers #included so far
+    UnitSummary summary;                          // call edges and external symbols of this file
+    TokenType declStorage = TokenType::TOK_UNKNOWN; // static/extern of the declaration being parsed
+    HeaderSet reportedHeaders = 0;                // missing headers already reported
+
+    Token curr() const { return index < unitEnd ? tokens[index] : Token(TokenType::TOK_EOF, ""); }
+
+    void recordNode(NodeKind kind, size_t at, size_t first, size_t last, const string &name = "",
+                    const string &type = "", int count = 0)
+    {
+        ruleNodes.push_back({kind, at, first, last, name, type, count});
+    }
+    Token peek(int offset = 1) const { return index + offset < unitEnd ? tokens[index + offset] : Token(TokenType::TOK_EOF, ""); }
 
-            sym.declare(structName, "struct_type");
+    void advance()
+    {
+        if (index < unitEnd)
+            index++;
+        classifyThrough(index + 1); // current token and peek()
+    }
+
+    // Parser -> token stream feedback: identifiers naming a typedef are tagged
+    // TYPEDEF_NAME once, as the parser reaches them, so type-name tests are an
+    // enum compare instead of a scope walk per inspection
+    void classifyThrough(size_t last)
+    {
+        if (typedefs.empty())
+        {
+            classifiedEnd = max(classifiedEnd, last + 1);
             return;
         }
+        for (; classifiedEnd <= last && classifiedEnd < tokens.size(); classifiedEnd++)
+        {
+            Token &t = tokens[classifiedEnd];
+            if (t.type == TokenType::TOK_IDENTIFIER && typedefs.count(t.value))
+                t.type = TokenType::TYPEDEF_NAME;
+        }
+    }
 
-        // struct <name> <declarator>...;
-        if (curr().type == TokenType::OP_STAR || curr().type == TokenType::TOK_IDENTIFIER)
+    // Lookahead may already have classified tokens past a change in the bindings
+    void reclassifyAhead()
+    {
+        for (size_t i = index; i < classifiedEnd && i < tokens.size(); i++)
         {
-            // allow pointer stars before identifier: struct Point *p;
-            string varType = "struct " + structName;
+            Token &t = tokens[i];
+            if (t.type == TokenType::TOK_IDENTIFIER || t.type == TokenType::TYPEDEF_NAME)
+                t.type = typedefs.count(t.value) ? TokenType::TYPEDEF_NAME : TokenType::TOK_IDENTIFIER;
+        }
+    }
 
-            varType += parsePointerStars();
+    // Binds name to type ("" unbinds it), remembering the old binding for closeScope()
+    void rebindTypedef(const string &name, const string &type)
+    {
+        auto it = typedefs.find(name);
+        typedefUndo.push_back({name, it == typedefs.end() ? "" : it->second});
+        if (type.empty())
+            typedefs.erase(name);
+        else
+            typedefs[name] = type;
+        reclassifyAhead();
+    }
 
-            if (curr().type == TokenType::TOK_IDENTIFIER)
+    // An ordinary declaration hides a typedef of the same name until its scope
+    // closes; in the typedef's own scope it is a redeclaration
+    void shadowTypedef(const Token &nameTok)
+    {
+        if (!typedefs.count(nameTok.value))
+            return;
+        size_t scopeStart = typedefMarks.empty() ? 0 : typedefMarks.back();
+        for (size_t i = scopeStart; i < typedefUndo.size(); i++)
+        {
+            if (typedefUndo[i].first == nameTok.value)
             {
-                Token nameTok = curr();
-                advance();
-                parseVarDecl(varType, nameTok.value, nameTok);
+                string err = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                             " - Redeclaration of '" + nameTok.value + "'";
+                errors.push_back({err, suggestionEngine.getSuggestion(err)});
                 return;
             }
         }
+        rebindTypedef(nameTok.value, "");
+    }
 
-        // forward decl: struct Point;
-        if (curr().type == TokenType::SEMICOLON)
-        {
-            advance();
-            sym.declare(structName, "struct_forward");
+    // After a complete type a typedef name can only be the declarator:
+    // "int T = 3;" declares a variable T
+    bool atDeclaratorName()
+    {
+        if (curr().type == TokenType::TYPEDEF_NAME)
+            tokens[index].type = TokenType::TOK_IDENTIFIER;
+        return curr().type == TokenType::TOK_IDENTIFIER;
+    }
+
+    // Block scopes own the typedefs declared or hidden inside them
+    void openScope()
+    {
+        sym.pushScope();
+        typedefMarks.push_back(typedefUndo.size());
+    }
+
+    void closeScope()
+    {
+        sym.popScope();
+        if (typedefMarks.empty())
+            return;
+        size_t mark = typedefMarks.back();
+        typedefMarks.pop_back();
+        if (typedefUndo.size() == mark)
             return;
+        while (typedefUndo.size() > mark)
+        {
+            auto &[name, previous] = typedefUndo.back();
+            if (previous.empty())
+                typedefs.erase(name);
+            else
+                typedefs[name] = previous;
+            typedefUndo.pop_back();
         }
+        reclassifyAhead();
+    }
 
-        Token bad = curr();
-        string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Invalid struct syntax";
-        errors.push_back({err, "SUGGESTION: struct <name> { ... }; or struct <name> <var>;"});
+    // Declarations record the underlying type, so "Node *p" is a "struct Node*"
+    string typeSpelling(const Token &t) const
+    {
+        if (t.type == TokenType::TYPEDEF_NAME)
+            return typedefs.at(t.value);
+        return t.value;
     }
 
-    // Handles "if (...)" statement logic
-    void parseIf()
+    // struct tags have their own namespace: "struct Node" stays valid after
+    // typedef struct Node Node; has tagged the name
+    static bool isTagToken(const Token &t)
     {
-        Token ifTok = curr();
-        advance(); // KW_IF
-        expect(TokenType::LPAREN, "(");
-        parseExpression();
-        expect(TokenType::RPAREN, ")");
-        if (curr().type == TokenType::SEMICOLON)
+        return t.type == TokenType::TOK_IDENTIFIER || t.type == TokenType::TYPEDEF_NAME;
+    }
+
+    void forceAdvance()
+    {
+        if (index == lastIndex)
         {
-            string errMsg = "Line " + to_string(ifTok.line) + ":" + to_string(ifTok.column) +
-                            " - Missing statement after 'if' condition";
-            string sug = "SUGGESTION: Add a statement or block after if";
+            Token bad = curr();
+            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Skipping invalid token '" + bad.value + "'";
+            string sug = suggestionEngine.getSuggestion(errMsg);
             errors.push_back({errMsg, sug});
             advance();
         }
-        else if (curr().type == TokenType::RBRACE || curr().type == TokenType::TOK_EOF)
+        lastIndex = index;
+    }
+
+    void expect(TokenType type, const string &desc)
+    {
+        Token bad = curr();
+        if (bad.type != type)
         {
-            string errMsg = "Line " + to_string(ifTok.line) + ":" + to_string(ifTok.column) +
-                            " - Missing statement after 'if' condition";
-            string sug = "SUGGESTION: Add a statement or block after if";
+            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected '" + desc + "' but got '" + bad.value + "'";
+            string sug = suggestionEngine.getSuggestion(errMsg);
             errors.push_back({errMsg, sug});
         }
         else
-        {
-            parseStatement();
-        }
-        if (curr().type == TokenType::KW_ELSE)
         {
             advance();
-            parseStatement();
         }
     }
 
-    // Handles "while (...)" and "for (...)" statement logic
-    void parseLoop()
+    bool isTypeToken(const Token &t) const
     {
-        Token loopTok = curr();
-        advance(); // KW_WHILE or KW_FOR
-        expect(TokenType::LPAREN, "(");
-        parseExpression();
-        expect(TokenType::RPAREN, ")");
-        if (curr().type == TokenType::SEMICOLON)
+        if (t.type == TokenType::KW_INT || t.type == TokenType::KW_FLOAT ||
+            t.type == TokenType::KW_CHAR || t.type == TokenType::KW_DOUBLE ||
+            t.type == TokenType::KW_VOID || t.type == TokenType::KW_STRUCT ||
+            t.type == TokenType::KW_AUTO || t.type == TokenType::KW_ENUM ||
+            t.type == TokenType::TYPEDEF_NAME)
+            return true;
+        return false;
+    }
+
+    // Would the token after a corrected keyword make sense? Keeps real identifiers
+    // (calls, assignments) from being rewritten just because they look like a keyword
+    bool fitsKeywordContext(TokenType kw, const Token &next) const
+    {
+        switch (kw)
         {
-            string errMsg = "Line " + to_string(loopTok.line) + ":" + to_string(loopTok.column) +
-                            " - Missing statement after loop condition";
-            string sug = "SUGGESTION: Add a statement or block";
-            errors.push_back({errMsg, sug});
-            advance();
+        case TokenType::KW_INT:
+        case TokenType::KW_FLOAT:
+        case TokenType::KW_CHAR:
+        case TokenType::KW_VOID:
+        case TokenType::KW_DOUBLE:
+        case TokenType::KW_STRUCT:
+        case TokenType::KW_ENUM:
+        case TokenType::KW_TYPEDEF:
+        case TokenType::KW_CONST:
+            return next.type == TokenType::TOK_IDENTIFIER || next.type == TokenType::OP_STAR ||
+                   isTypeToken(next);
+        case TokenType::KW_IF:
+        case TokenType::KW_WHILE:
+        case TokenType::KW_FOR:
+            return next.type == TokenType::LPAREN && !isCallStatement(index + 1);
+        case TokenType::KW_RETURN:
+            return next.type == TokenType::SEMICOLON || next.type == TokenType::TOK_NUMBER ||
+                   next.type == TokenType::TOK_IDENTIFIER || next.type == TokenType::TOK_STRING ||
+                   next.type == TokenType::TOK_CHAR || next.type == TokenType::OP_MINUS ||
+                   next.type == TokenType::OP_NOT || next.type == TokenType::OP_BITAND;
+        case TokenType::KW_ELSE:
+            return next.type == TokenType::LBRACE || next.type == TokenType::KW_IF;
+        default:
+            return false; // keywords the statement parser has no handling for
         }
-        else
+    }
+
+    // fork(); or fork() + 1: the parenthesis at open ends a call, not a condition
+    bool isCallStatement(size_t open) const
+    {
+        int depth = 0;
+        for (size_t i = open; i < tokens.size() && tokens[i].type != TokenType::TOK_EOF; i++)
         {
-            parseStatement();
+            if (tokens[i].type == TokenType::LPAREN)
+                depth++;
+            else if (tokens[i].type == TokenType::RPAREN && --depth == 0)
+            {
+                if (i + 1 >= tokens.size())
+                    return true;
+                // Operators that also start statements (*p = 0;) prove nothing
+                TokenType after = tokens[i + 1].type;
+                return after == TokenType::SEMICOLON || after == TokenType::COMMA ||
+                       after == TokenType::QUESTION || (isValidBinaryOp(after) && after != TokenType::OP_STAR);
+            }
+            else if (tokens[i].type == TokenType::LBRACE || tokens[i].type == TokenType::SEMICOLON)
+                return false; // for (;;) or an unbalanced condition
         }
+        return false;
     }
 
-    void parseStatement()
+    // Rewrites a near-miss keyword at statement start (itn x; retrun 0; whiel (...))
+    // into the intended keyword, so one diagnostic is reported instead of a cascade
+    void correctKeywordTypo()
     {
-        Token t = curr();
+        if (index >= tokens.size() || tokens[index].type != TokenType::TOK_IDENTIFIER)
+            return;
 
-        // Handle preprocessor
-        if (t.type == TokenType::PREPROCESSOR)
+        Token &t = tokens[index];
+        const KeywordSpellChecker::Entry *match = KeywordSpellChecker::instance().closestKeyword(t.value);
+        if (!match || !fitsKeywordContext(match->type, peek()) || sym.exists(t.value))
+            return;
+        if (stdLib.isStandardFunction(t.value) || findSignature(StringInterner::current().intern(t.value)))
+            return; // a function this file or the library declares
+
+        string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                        " - Misspelled keyword '" + t.value + "', did you mean '" + match->word + "'?";
+        errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
+
+        t.type = match->type;
+        t.value = match->word;
+    }
+
+    bool isComparisonOp(const Token &t)
+    {
+        return t.type == TokenType::OP_LT || t.type == TokenType::OP_GT ||
+               t.type == TokenType::OP_LE || t.type == TokenType::OP_GE ||
+               t.type == TokenType::OP_EQ || t.type == TokenType::OP_NE;
+    }
+
+    bool isOp(const Token &t)
+    {
+        return isValidBinaryOp(t.type);
+    }
+
+    bool isValidUnaryOp(TokenType type)
+    {
+        return type == TokenType::OP_MINUS || type == TokenType::OP_PLUS ||
+               type == TokenType::OP_NOT || type == TokenType::OP_BITNOT ||
+               type == TokenType::OP_INC || type == TokenType::OP_DEC;
+    }
+
+    bool isValidBinaryOp(TokenType type) const
+    {
+        return type == TokenType::OP_PLUS || type == TokenType::OP_MINUS ||
+               type == TokenType::OP_STAR || type == TokenType::OP_SLASH ||
+               type == TokenType::OP_PERCENT || type == TokenType::OP_ASSIGN ||
+               type == TokenType::OP_EQ || type == TokenType::OP_NE ||
+               type == TokenType::OP_LT || type == TokenType::OP_GT ||
+               type == TokenType::OP_LE || type == TokenType::OP_GE ||
+               type == TokenType::OP_AND || type == TokenType::OP_OR ||
+               type == TokenType::OP_BITAND || type == TokenType::OP_BITOR ||
+               type == TokenType::OP_BITXOR || type == TokenType::OP_SHL ||
+               type == TokenType::OP_SHR;
+    }
+
+    string parsePointerStars()
+    {
+        string ptr = "";
+        while (curr().type == TokenType::OP_STAR)
         {
+            ptr += "*";
             advance();
-            return;
         }
+        return ptr;
+    }
 
-        // Handle block
-        if (t.type == TokenType::LBRACE)
+    // 2.5 is a double, 2.5f a float, 10L a long
+    static string literalType(const Token &t)
+    {
+        if (t.numFlags & NUM_FLOAT)
+            return (t.numFlags & NUM_FSUFFIX) ? "float" : "double";
+        if (t.numFlags & (NUM_LONG | NUM_LONGLONG))
+            return "long";
+        return "int";
+    }
+
+    static uint32_t typeId(const string &type) { return StringInterner::current().intern(type); }
+    static const string &typeName(uint32_t type) { return StringInterner::current().name(type); }
+
+    uint32_t literalTypeId(const Token &t) const
+    {
+        if (t.numFlags & NUM_FLOAT)
+            return (t.numFlags & NUM_FSUFFIX) ? floatType : doubleType;
+        if (t.numFlags & (NUM_LONG | NUM_LONGLONG))
+            return longType;
+        return intType;
+    }
+
+    string getExpressionType(const Token &t)
+    {
+        if (t.type == TokenType::TOK_NUMBER)
+            return literalType(t);
+        if (t.type == TokenType::TOK_STRING)
+            return "string";
+        if (t.type == TokenType::TOK_CHAR)
+            return "char";
+        if (t.type == TokenType::TOK_IDENTIFIER)
+            return sym.getType(t.value);
+        return "UNKNOWN";
+    }
+
+    uint32_t parseExpressionWithType()
+    {
+        uint32_t type = parsePrimaryWithType();
+        while (isOp(curr()))
         {
+            Token op = curr();
             advance();
-            sym.pushScope();
-            parseBlock();
-            sym.popScope();
-            return;
+            if (op.type == TokenType::OP_AND || op.type == TokenType::OP_OR)
+                countDecision();
+            uint32_t rhsType = parsePrimaryWithType();
+
+            if constexpr (Policy::typeChecks)
+            {
+                // Check type compatibility
+                if (type != unknownType && rhsType != unknownType)
+                {
+                    string resultType = TypeSystem::getOperationResultType(typeName(type), typeName(rhsType), op.value);
+
+                    if (resultType == "INVALID")
+                    {
+                        string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
+                                        " - Type error: cannot apply '" + op.value + "' to '" + typeName(type) +
+                                        "' and '" + typeName(rhsType) + "'";
+                        string sug = "SUGGESTION: Ensure both operands are compatible types";
+                        errors.push_back({errMsg, sug});
+                    }
+                    else if (resultType != "UNKNOWN")
+                        type = typeId(resultType);
+                }
+            }
         }
+        return type;
+    }
 
-        // Handle control flow
-        if (t.type == TokenType::KW_IF)
+    // ---- complexity metrics (no-ops outside a function body) ----
+
+    void countDecision()
+    {
+        if (metrics)
+            metrics->cyclomaticComplexity++;
+    }
+
+    void countStatement()
+    {
+        if (metrics)
+            metrics->statementCount++;
+    }
+
+    void enterNesting()
+    {
+        nestingDepth++;
+        if (metrics)
+            metrics->maxNestingDepth = max(metrics->maxNestingDepth, nestingDepth);
+    }
+
+    // ---- dataflow bookkeeping (no-ops outside a function body) ----
+
+    uint32_t flowNewBlock()
+    {
+        if constexpr (Policy::flowChecks)
+            return flow ? flow->newBlock() : 0;
+        return 0;
+    }
+
+    void flowEdge(uint32_t from, uint32_t to)
+    {
+        if constexpr (Policy::flowChecks)
+            if (flow)
+                flow->addEdge(from, to);
+    }
+
+    // Only scalars and pointers are tracked; arrays and struct values are assigned piecewise
+    void flowTrackVariable(const string &name, const string &type, const Token &nameTok, bool isParam)
+    {
+        if constexpr (!Policy::flowChecks)
+            return;
+        if (!flow || type.find("[]") != string::npos ||
+            (TypeSystem::isStruct(type) && !TypeSystem::isPointer(type)))
+            return;
+        VarInfo *v = sym.lookup(name);
+        if (!v)
+            return;
+        v->flowSlot = flow->addVariable(name, nameTok.line, nameTok.column, isParam);
+        if (isParam)
+            flowEvent(FlowEvent::DEF, name, nameTok);
+    }
+
+    void flowEvent(FlowEvent::Kind kind, const string &name, const Token &at, bool isInit = false)
+    {
+        if constexpr (!Policy::flowChecks)
+            return;
+        if (!flow)
+            return;
+        VarInfo *v = sym.lookup(name);
+        if (!v || v->flowSlot < 0)
+            return;
+        if (unevaluated)
         {
-            parseIf();
+            if (kind == FlowEvent::USE)
+                flow->vars[v->flowSlot].unevaluatedUse = true;
             return;
         }
+        flow->blocks[flowBlock].events.push_back({kind, isInit, uint32_t(v->flowSlot), at.line, at.column});
+    }
 
-        if (t.type == TokenType::KW_WHILE || t.type == TokenType::KW_FOR)
+    // Runs definite-assignment and liveness over a finished function body
+    void reportFlowDiagnostics(const FunctionFlowGraph &graph)
+    {
+        DataflowSolver solver(graph);
+        vector<BitSet> assignedIn = solver.definitelyAssignedIn();
+        vector<BitSet> liveOut = solver.liveOut();
+
+        vector<pair<pair<int, int>, pair<string, string>>> found; // ((line, col), diagnostic)
+        vector<uint8_t> used(graph.vars.size(), 0), escaped(graph.vars.size(), 0), assignedLater(graph.vars.size(), 0);
+        vector<const FlowEvent *> firstUninitUse(graph.vars.size(), nullptr); // earliest in source order
+
+        for (const FlowBlock &block : graph.blocks)
         {
-            parseLoop();
-            return;
+            for (const FlowEvent &e : block.events)
+            {
+                if (e.kind != FlowEvent::DEF)
+                    used[e.var] = 1;
+                if (e.kind == FlowEvent::ESCAPE)
+                    escaped[e.var] = 1;
+                if (e.kind == FlowEvent::DEF && !e.isInit)
+                    assignedLater[e.var] = 1;
+            }
         }
 
-        if (t.type == TokenType::KW_RETURN)
+        for (uint32_t b : solver.order())
         {
-            advance();
-            if (curr().type != TokenType::SEMICOLON)
-                parseExpressionWithFullType();
-            expect(TokenType::SEMICOLON, ";");
-            return;
+            BitSet assigned = assignedIn[b];
+            for (const FlowEvent &e : graph.blocks[b].events)
+            {
+                const FlowEvent *&first = firstUninitUse[e.var];
+                if (e.kind == FlowEvent::USE && !assigned.test(e.var) &&
+                    (!first || make_pair(e.line, e.column) < make_pair(first->line, first->column)))
+                    first = &e;
+                if (e.kind != FlowEvent::USE)
+                    assigned.set(e.var);
+            }
+
+            BitSet live = liveOut[b];
+            const vector<FlowEvent> &events = graph.blocks[b].events;
+            for (auto e = events.rbegin(); e != events.rend(); ++e)
+            {
+                if (e->kind == FlowEvent::DEF)
+                {
+                    if (!live.test(e->var) && !e->isInit && used[e->var] && !escaped[e->var])
+                    {
+                        found.push_back({{e->line, e->column},
+                                         {"Warning: Line " + to_string(e->line) + ":" + to_string(e->column) +
+                                              " - Value assigned to '" + graph.vars[e->var].name + "' is never used",
+                                          "SUGGESTION: Remove the assignment or use the value"}});
+                    }
+                    live.reset(e->var);
+                }
+                else
+                {
+                    live.set(e->var);
+                }
+            }
         }
 
-        if (t.type == TokenType::SEMICOLON)
+        for (size_t v = 0; v < graph.vars.size(); v++)
+        {
+            const FlowVariable &var = graph.vars[v];
+            if (const FlowEvent *e = firstUninitUse[v])
+            {
+                found.push_back({{e->line, e->column},
+                                 {"Warning: Line " + to_string(e->line) + ":" + to_string(e->column) +
+                                      " - Variable '" + var.name + "' may be used uninitialized",
+                                  "SUGGESTION: Initialize '" + var.name + "' when declaring it, e.g. int " + var.name + " = 0;"}});
+            }
+            if (!used[v] && !var.isParam && !var.unevaluatedUse)
+            {
+                // "k = 1;" with no later read is a different mistake from a forgotten declaration
+                found.push_back({{var.line, var.column},
+                                 {"Warning: Line " + to_string(var.line) + ":" + to_string(var.column) +
+                                      " - Variable '" + var.name +
+                                      (assignedLater[v] ? "' is set but its value is never read" : "' is declared but never used"),
+                                  assignedLater[v] ? "SUGGESTION: Remove the variable and its assignments, or read the value"
+                                                   : "SUGGESTION: Remove the unused variable"}});
+            }
+        }
+
+        sort(found.begin(), found.end(), [](const auto &a, const auto &b)
+             { return a.first < b.first; });
+        for (auto &f : found)
+            errors.push_back(f.second);
+    }
+
+    static bool isStorageClass(const Token &t)
+    {
+        return t.type == TokenType::KW_STATIC || t.type == TokenType::KW_EXTERN;
+    }
+
+    void parseDeclOrFunc()
+    {
+        declStorage = TokenType::TOK_UNKNOWN;
+        while (isStorageClass(curr()))
         {
+            declStorage = curr().type;
             advance();
-            return;
         }
+        parseDeclarator();
+        declStorage = TokenType::TOK_UNKNOWN;
+    }
 
-        // ============================================================================
-        // Handle typedef: typedef int MyInt; typedef struct Point MyPoint;
-        // ============================================================================
-        // Inside parseStatement()
-        if (t.type == TokenType::KW_TYPEDEF)
+    // The rest of a declaration, after any storage class
+    void parseDeclarator()
+    {
+        if (curr().type == TokenType::KW_ENUM)
         {
-            parseTypedef();
+            parseEnum();
             return;
         }
-        // ============================================================================
-        // Handle const keyword at statement start: const int x = 5;
-        // ============================================================================
-        if (t.type == TokenType::KW_CONST)
-        {
-            advance();
 
-            if (!isTypeToken(curr()))
+        // start type
+        string typeName = typeSpelling(curr());
+        advance();
+
+        // SPECIAL: struct <Tag> as a type name or a definition
+        if (typeName == "struct")
+        {
+            if (!isTagToken(curr()))
             {
                 Token bad = curr();
-                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                " - Expected type after const";
-                string sug = "SUGGESTION: const <type> <variable_name>;";
-                errors.push_back({errMsg, sug});
+                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected struct name";
+                errors.push_back({err, "SUGGESTION: struct <name> { ... } ; or struct <name> var;"});
+                advance();
                 return;
             }
-
-            string type = "const " + curr().value;
+            string tag = curr().value;
+            Token tagTok = curr();
             advance();
 
-            // Handle pointers: const int *p;
-            type += parsePointerStars();
-
-            if (curr().type != TokenType::TOK_IDENTIFIER)
+            // struct <Tag> { ... }  → hand to parseStruct()
+            if (curr().type == TokenType::LBRACE)
             {
-                Token bad = curr();
-                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                " - Expected identifier after const type";
-                string sug = "SUGGESTION: Provide variable name";
-                errors.push_back({errMsg, sug});
-                return;
+                // step back one token to let parseStruct() consume as if KW_STRUCT was just read
+                index -= 2; // back to 'struct'
+                return parseStruct();
             }
 
-            if (t.type == TokenType::OP_PLUS)
-            {
-                // Unary + at statement level should only be allowed if numeric
-                Token opTok = curr();
-                advance();
+            // Otherwise it's a type name: "struct Tag"
+            typeName = "struct " + tag;
+        }
 
-                if (curr().type == TokenType::TOK_IDENTIFIER)
-                {
-                    string id = curr().value;
-                    string idType = sym.getType(id);
+        // handle pointer tokens after type (int **p)
+        typeName += parsePointerStars();
 
-                    if (idType == "function" ||
-                        idType == "" ||
-                        idType == "string" ||
-                        idType == "char" ||
-                        idType == "void")
-                    {
-                        errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                                              " - Invalid use of unary '+' at statement level",
-                                          "SUGGESTION: Statements cannot start with unary '+' unless it's a numeric expression"});
-                        return;
-                    }
-                }
+        if (!atDeclaratorName())
+        {
+            Token bad = curr();
+            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected identifier";
+            errors.push_back({err, suggestionEngine.getSuggestion(err)});
+            advance();
+            return;
+        }
 
-                // If numeric, parse normally
-                parsePrimaryWithType();
-                expect(TokenType::SEMICOLON, ";");
-                return;
-            }
+        Token nameTok = curr();
+        string ident = nameTok.value;
+        advance();
 
-            Token nameTok = curr();
-            string ident = nameTok.value;
-            advance();
+        if (curr().type == TokenType::LPAREN)
+            parseFunction(typeName, ident, nameTok);
+        else
+            parseVarDecl(typeName, ident, nameTok);
+    }
 
-            parseVarDecl(type, ident, nameTok);
-            return;
+    void recordExternal(const Token &nameTok, const string &type, bool definition)
+    {
+        StringInterner &ids = StringInterner::current();
+        summary.externals.push_back({ids.intern(nameTok.value), ids.intern(type), nameTok.line, nameTok.column, definition});
+    }
+
+    // Declares one variable of the current declaration. File-scope objects
+    // have external linkage unless static and may be declared again through
+    // extern; locals that outlive the call (static, extern) are not tracked
+    // by the dataflow checks. nullptr when the name was already taken.
+    VarInfo *declareVariable(const Token &nameTok, const string &type)
+    {
+        bool isExtern = declStorage == TokenType::KW_EXTERN;
+        bool linked = (scopeDepth == 0 && declStorage != TokenType::KW_STATIC) || isExtern;
+        if (linked)
+            recordExternal(nameTok, type, !isExtern || curr().type == TokenType::OP_ASSIGN);
+        else if (scopeDepth == 0)
+            summary.staticObjects.push_back(StringInterner::current().intern(nameTok.value));
+
+        shadowTypedef(nameTok);
+        if (!sym.declare(nameTok.value, type, nameTok.line, nameTok.column))
+        {
+            VarInfo *prev = sym.lookup(nameTok.value);
+            if (linked && prev && (prev->externDecl || isExtern) && prev->type == type)
+            {
+                prev->externDecl = prev->externDecl && isExtern;
+                return nullptr;
+            }
+            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                            " - Redeclaration of '" + nameTok.value + "'";
+            errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
+            return nullptr;
         }
 
-        // ============================================================================
-        // Handle struct declarations
-        // ============================================================================
-        // Inside parseStatement() in struct section
-        if (t.type == TokenType::KW_STRUCT)
+        VarInfo *v = sym.lookup(nameTok.value);
+        v->externDecl = isExtern;
+        v->fileScope = scopeDepth == 0 || isExtern;
+        if (declStorage == TokenType::TOK_UNKNOWN)
+            flowTrackVariable(nameTok.value, type, nameTok, false);
+        return v;
+    }
+
+    void parseVarDecl(const string &type, const string &ident, const Token &nameTok)
+    {
+        string declaredType = type; // Already includes pointers from parseStatement
+        size_t nameIndex = index - 1;
+
+        // Handle leading pointer tokens before variable name (int *p)
+        declaredType += parsePointerStars();
+        recordNode(NodeKind::VarDecl, nameIndex, nameIndex, nameIndex + 1, ident, declaredType);
+
+        bool isArray = false;
+        int64_t arrayLength = -1;
+
+        // Check for array declarator
+        if (curr().type == TokenType::LBRACKET)
         {
-            parseStruct();
-            return;
+            isArray = true;
+            arrayLength = parseArrayDeclarator(nameTok);
+            declaredType += "[]";
         }
-        // ============================================================================
-        // Handle regular type declarations (int, float, etc.)
-        // ============================================================================
-        if (isTypeToken(t))
+
+        VarInfo *declared = declareVariable(nameTok, declaredType);
+        if (declared)
+            declared->arrayLength = arrayLength;
+
+        if (curr().type == TokenType::OP_ASSIGN)
         {
-            string type = t.value;
+            Token assignTok = curr();
             advance();
 
-            // Skip const if it's after type (shouldn't happen with our grammar)
-            if (curr().type == TokenType::KW_CONST)
+            if (isArray && curr().type == TokenType::LBRACE)
             {
-                type += " const";
                 advance();
+                int elementCount = 0;
+                if (curr().type != TokenType::RBRACE)
+                {
+                    while (true)
+                    {
+                        parseExpression();
+                        elementCount++;
+                        if (curr().type == TokenType::COMMA)
+                            advance();
+                        else
+                            break;
+                    }
+                }
+                expect(TokenType::RBRACE, "}");
+                if (declared && arrayLength < 0) // int a[] = {1, 2, 3};
+                    declared->arrayLength = elementCount;
+                if constexpr (Policy::typeChecks)
+                {
+                    if (arrayLength >= 0 && arrayLength < elementCount)
+                    {
+                        string errMsg = "Line " + to_string(assignTok.line) + ":" + to_string(assignTok.column) +
+                                        " - Array size mismatch: declared " + to_string(arrayLength) +
+                                        " but initialized with " + to_string(elementCount) + " elements";
+                        string sug = "SUGGESTION: Increase array size or reduce initializer elements";
+                        errors.push_back({errMsg, sug});
+                    }
+                }
             }
 
-            // Handle pointers: int *p;
-            type += parsePointerStars();
-
-            if (curr().type != TokenType::TOK_IDENTIFIER)
+            else
             {
-                Token bad = curr();
-                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                                " - Expected identifier after type '" + type + "'";
-                string sug = "SUGGESTION: Provide variable or function name";
-                errors.push_back({errMsg, sug});
-                return;
+                uint32_t rhsType = parseExpressionWithFullType();
+                flowEvent(FlowEvent::DEF, ident, nameTok, true);
+
+                if constexpr (Policy::typeChecks)
+                {
+                    if (rhsType != unknownType && !TypeSystem::areTypesCompatible(declaredType, typeName(rhsType)))
+                    {
+                        string errMsg = "Warning: Line " + to_string(assignTok.line) + ":" + to_string(assignTok.column) +
+                                        " - Type mismatch: assigning '" + typeName(rhsType) + "' to '" + declaredType + "'";
+                        string sug = "SUGGESTION: Types must be compatible";
+                        errors.push_back({errMsg, sug});
+                    }
+                }
             }
+        }
 
-            Token nameTok = curr();
-            string ident = nameTok.value;
+        // Handle multiple declarations: int *p, **q, arr[5];
+        // REPLACE the "while (curr().type == TokenType::COMMA) { ... }" in parseVarDecl with:
+        while (curr().type == TokenType::COMMA)
+        {
             advance();
 
-            // Function or variable?
-            if (curr().type == TokenType::LPAREN)
-            {
-                parseFunction(type, ident, nameTok);
-            }
-            else
+            // collect any pointer stars BEFORE the next identifier
+            string nextDeclaredType = type; // base type for next variable eg: int a, b;
+
+            nextDeclaredType += parsePointerStars();
+
+            if (!atDeclaratorName())
             {
-                parseVarDecl(type, ident, nameTok);
+                Token bad = curr();
+                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Expected identifier";
+                errors.push_back({err, "SUGGESTION: Provide a variable name after ',' (example: int *a, **b;)"});
+                break;
             }
-            return;
-        }
-        // ===============================================
-        // NEW: Reject invalid statement starters
-        // ===============================================
-        Token st = curr();
-
-        bool isValidStart =
-            st.type == TokenType::TOK_IDENTIFIER ||
-            st.type == TokenType::TOK_NUMBER ||
-            st.type == TokenType::TOK_STRING ||
-            st.type == TokenType::TOK_CHAR ||
-            st.type == TokenType::LPAREN ||
-            st.type == TokenType::OP_MINUS ||
-            st.type == TokenType::OP_PLUS ||
-            st.type == TokenType::OP_NOT ||
-            st.type == TokenType::OP_BITNOT ||
-            st.type == TokenType::OP_INC ||
-            st.type == TokenType::OP_DEC;
 
-        if (!isValidStart)
-        {
-            string err =
-                "Line " + to_string(st.line) + ":" + to_string(st.column) +
-                " - Invalid statement start: '" + st.value + "'";
-            errors.push_back({err, "SUGGESTION: Statements must begin with an expression, literal, or identifier"});
+            Token t = curr(); // the identifier
             advance();
-            return;
-        }
 
-        // Extra rule: *, /, % cannot start a statement
-        if (st.type == TokenType::OP_STAR ||
-            st.type == TokenType::OP_SLASH ||
-            st.type == TokenType::OP_PERCENT)
-        {
-            string err =
-                "Line " + to_string(st.line) + ":" + to_string(st.column) +
-                " - Invalid statement start: '" + st.value + "'";
-            errors.push_back({err, "SUGGESTION: Statements cannot begin with '" + st.value + "'"});
-            advance();
-            return;
-        }
+            // optional array declarator: int *a, **b[10]
+            int64_t nextLength = -1;
+            if (curr().type == TokenType::LBRACKET)
+            {
+                nextLength = parseArrayDeclarator(t);
+                nextDeclaredType += "[]";
+            }
 
-        // Unary op cannot apply to function name
-        if (st.type == TokenType::OP_MINUS ||
-            st.type == TokenType::OP_PLUS ||
-            st.type == TokenType::OP_NOT ||
-            st.type == TokenType::OP_BITNOT)
-        {
-            Token nxt = peek();
-            if (nxt.type == TokenType::TOK_IDENTIFIER &&
-                sym.getType(nxt.value) == "function")
+            if (VarInfo *next = declareVariable(t, nextDeclaredType))
+                next->arrayLength = nextLength;
+
+            if (curr().type == TokenType::OP_ASSIGN)
             {
-                string err =
-                    "Line " + to_string(st.line) + ":" + to_string(st.column) +
-                    " - Invalid unary operator '" + st.value + "' applied to function '" + nxt.value + "'";
-                errors.push_back({err, "SUGGESTION: Unary operators only apply to numeric expressions"});
                 advance();
-                return;
+                uint32_t rhsType = parseExpressionWithFullType();
+                flowEvent(FlowEvent::DEF, t.value, t, true);
+
+                if constexpr (Policy::typeChecks)
+                {
+                    if (rhsType != unknownType && !TypeSystem::areTypesCompatible(nextDeclaredType, typeName(rhsType)))
+                    {
+                        errors.push_back({"Warning: Line " + to_string(t.line) + ":" + to_string(t.column) + " - Type mismatch",
+                                          "SUGGESTION: Types must match"});
+                    }
+                }
             }
         }
 
-        // Handle other statement types...
-        parseExprOrAssignment();
         expect(TokenType::SEMICOLON, ";");
     }
 
-    void parseExprOrAssignment()
+    void parseFunction(const std::string &type, const std::string &ident, const Token &nameTok)
     {
-        Token t = curr();
-
-        // ============================================
-        // 1) COMPOUND ASSIGNMENTS (+= -= *= /= %=)
-        // MUST COME BEFORE NORMAL EXPRESSION PARSING
-        // ============================================
-        if (t.type == TokenType::TOK_IDENTIFIER &&
-            (peek().type == TokenType::OP_PLUSEQ ||
-             peek().type == TokenType::OP_MINUSEQ ||
-             peek().type == TokenType::OP_MULTEQ ||
-             peek().type == TokenType::OP_DIVEQ ||
-             peek().type == TokenType::OP_MODEQ))
+        size_t nameIndex = index - 1; // callers stop on the '(' after the name
+        // Reject nested functions
+        if (scopeDepth > 0)
         {
-            Token idTok = curr();
-            string lhsType = sym.getType(idTok.value);
+            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                            " - Invalid: nested function declaration '" + ident + "'";
+            string sug = "SUGGESTION: C does not support nested functions. Move to file scope";
+            errors.push_back({errMsg, sug});
 
-            if (!sym.exists(idTok.value))
+            while (curr().type != TokenType::LBRACE && curr().type != TokenType::SEMICOLON &&
+                   curr().type != TokenType::TOK_EOF)
             {
-                string err = "Line " + to_string(idTok.line) + ":" +
-                             to_string(idTok.column) +
-                             " - Undeclared variable '" + idTok.value + "'";
-                errors.push_back({err, suggestionEngine.getSuggestion(err)});
+                advance();
             }
-
-            advance(); // consume identifier
-            Token opTok = curr();
-            advance(); // consume the +=, -=, etc
-
-            string rhsType = parseExpressionWithFullType();
-
-            // TYPE CHECK
-            if (lhsType != "UNKNOWN" &&
-                rhsType != "UNKNOWN" &&
-                !TypeSystem::areTypesCompatible(lhsType, rhsType))
+            if (curr().type == TokenType::SEMICOLON)
             {
-                string err =
-                    "Warning: Line " + to_string(opTok.line) + ":" +
-                    to_string(opTok.column) +
-                    " - Type mismatch in compound assignment '" + opTok.value + "'";
-                errors.push_back({err, "SUGGESTION: Use matching arithmetic types"});
+                advance();
+            }
+
+            else if (curr().type == TokenType::LBRACE)
+            {
+                int braceCount = 1;
+                advance();
+                while (braceCount > 0 && curr().type != TokenType::TOK_EOF) // to skip the block entirely
+                {
+                    if (curr().type == TokenType::LBRACE)
+                        braceCount++;
+                    if (curr().type == TokenType::RBRACE)
+                        braceCount--;
+                    advance();
+                }
+            }
+            return;
+        }
+
+        // Library functions cannot be redefined
+        if (stdLib.isStandardFunction(ident))
+        {
+            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                            " - Redeclaration of function '" + ident + "'";
+            string sug = "SUGGESTION: Function '" + ident + "' is already declared";
+            errors.push_back({errMsg, sug});
+        }
+
+        sym.declare(ident, "function");
+        advance();
+        openScope();
+        scopeDepth++;
+
+        FunctionFlowGraph graph;
+        if constexpr (Policy::flowChecks)
+            flow = &graph;
+        flowBlock = FunctionFlowGraph::ENTRY;
+
+        FunctionSignature sig;
+        sig.returnType = StringInterner::current().intern(FunctionSignature::normalizeType(type));
+        vector<RuleNode> paramNodes; // reported only if this turns out to be a definition
+
+        // Parse parameters: (void), (int a, char *b) or unnamed prototype parameters (int, char *)
+        if (curr().type == TokenType::KW_VOID && peek().type == TokenType::RPAREN)
+        {
+            advance();
+        }
+        else if (curr().type != TokenType::RPAREN)
+        {
+            while (true)
+            {
+                string pType = "";
+                if (curr().type == TokenType::KW_CONST)
+                {
+                    pType = "const ";
+                    advance();
+                }
+
+                if (!isTypeToken(curr()))
+                {
+                    Token bad = curr();
+                    string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                    " - Expected type";
+                    string sug = suggestionEngine.getSuggestion(errMsg);
+                    errors.push_back({errMsg, sug});
+                    break;
+                }
+
+                pType += typeSpelling(curr());
+                advance();
+
+                // struct <Tag> parameter types
+                if ((pType == "struct" || pType == "const struct") && isTagToken(curr()))
+                {
+                    pType += " " + curr().value;
+                    advance();
+                }
+                else if (pType == "enum" || pType == "const enum") // enumerations are ints
+                {
+                    pType = pType == "enum" ? "int" : "const int";
+                    if (isTagToken(curr()))
+                        advance();
+                }
+
+                pType += parsePointerStars();
+                sig.paramTypes.push_back(StringInterner::current().intern(FunctionSignature::normalizeType(pType)));
+
+                if (atDeclaratorName())
+                {
+                    Token paramTok = curr();
+                    shadowTypedef(paramTok);
+                    if (sym.declare(paramTok.value, pType))
+                        flowTrackVariable(paramTok.value, pType, paramTok, true);
+                    string valueType = pType.compare(0, 6, "const ") ? pType : pType.substr(6);
+                    if (!TypeSystem::isPointer(valueType) &&
+                        (TypeSystem::isStruct(valueType) || typedefs.count(valueType)))
+                        paramNodes.push_back({NodeKind::Parameter, index, index, index + 1, paramTok.value, valueType,
+                                              (int)sizeOfType(valueType)});
+                    advance();
+                }
+                else if (curr().type != TokenType::COMMA && curr().type != TokenType::RPAREN)
+                {
+                    Token bad = curr();
+                    string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                    " - Expected parameter name";
+                    string sug = suggestionEngine.getSuggestion(errMsg);
+                    errors.push_back({errMsg, sug});
+                    break;
+                }
+
+                if (curr().type == TokenType::COMMA)
+                    advance();
+                else
+                    break;
+            }
+        }
+
+        expect(TokenType::RPAREN, ")");
+
+        sig.defined = curr().type != TokenType::SEMICOLON;
+        sig.internal = declStorage == TokenType::KW_STATIC;
+        if (sig.defined)
+            ruleNodes.insert(ruleNodes.end(), paramNodes.begin(), paramNodes.end());
+        if constexpr (Policy::callChecks)
+            registerSignature(ident, nameTok, sig);
+        bool internalLinkage = sig.internal;
+        if (!internalLinkage)
+            recordExternal(nameTok, signatureSpelling(sig), sig.defined);
+
+        if (curr().type == TokenType::SEMICOLON)
+        {
+            advance();
+            flow = nullptr;
+            scopeDepth--;
+            closeScope();
+            return;
+        }
+
+        expect(TokenType::LBRACE, "{");
+        flowBlock = flowNewBlock();
+        flowEdge(FunctionFlowGraph::ENTRY, flowBlock);
+
+        FunctionMetrics fnMetrics;
+        fnMetrics.name = ident;
+        fnMetrics.line = nameTok.line;
+        metrics = &fnMetrics;
+        nestingDepth = 0;
+        recordNode(NodeKind::FunctionBegin, nameIndex, nameIndex, index, ident, type);
+        parseBlock();
+        recordNode(NodeKind::FunctionEnd, index - 1, nameIndex, index, ident, type);
+        metrics = nullptr;
+        if (internalLinkage)
+            summary.staticFunctions.push_back(functionMetrics.size());
+        functionMetrics.push_back(fnMetrics);
+
+        flowEdge(flowBlock, FunctionFlowGraph::EXIT);
+        flow = nullptr;
+        if constexpr (Policy::flowChecks)
+            reportFlowDiagnostics(graph);
+        scopeDepth--;
+        closeScope();
+    }
+
+    // "int(char*,...)": the type a function is linked under
+    static string signatureSpelling(const FunctionSignature &sig)
+    {
+        StringInterner &ids = StringInterner::current();
+        string s = ids.name(sig.returnType) + "(";
+        for (size_t i = 0; i < sig.paramTypes.size(); i++)
+            s += (i ? "," : "") + ids.name(sig.paramTypes[i]);
+        if (sig.variadic)
+            s += sig.paramTypes.empty() ? "..." : ",...";
+        return s + ")";
+    }
+
+    // Records a user function's signature; a prototype may be followed by one matching definition
+    void registerSignature(const string &ident, const Token &nameTok, FunctionSignature &sig)
+    {
+        uint32_t nameId = StringInterner::current().intern(ident);
+        auto prev = userSignatures.find(nameId);
+        if (prev == userSignatures.end())
+        {
+            userSignatures.emplace(nameId, sig);
+            return;
+        }
+
+        if (prev->second.defined && sig.defined)
+        {
+            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                            " - Redeclaration of function '" + ident + "'";
+            string sug = "SUGGESTION: Function '" + ident + "' is already declared";
+            errors.push_back({errMsg, sug});
+        }
+        else if (!prev->second.sameShape(sig))
+        {
+            string errMsg = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                            " - Conflicting types for function '" + ident + "'";
+            errors.push_back({errMsg, "SUGGESTION: Make the prototype and the definition use the same return and parameter types"});
+        }
+
+        sig.defined = sig.defined || prev->second.defined;
+        sig.internal = sig.internal || prev->second.internal; // the first declaration fixes linkage
+        prev->second = sig;
+    }
+
+    // A library function called without its header is implicitly declared;
+    // reported once per header
+    void checkHeaderIncluded(const Token &idTok, int8_t header)
+    {
+        if (preprocessor.isHeaderIncluded(header) || ((reportedHeaders >> header) & 1))
+            return;
+        reportedHeaders |= HeaderSet(1) << header;
+        string name = StandardLibrary::headerName(header);
+        errors.push_back({"Warning: Line " + to_string(idTok.line) + ":" + to_string(idTok.column) + " - Uses '" +
+                              idTok.value + "' but does not include <" + name + ">",
+                          "SUGGESTION: Add #include <" + name + "> at the top of the file"});
+    }
+
+    const FunctionSignature *findSignature(uint32_t nameId) const
+    {
+        auto it = userSignatures.find(nameId);
+        if (it != userSignatures.end())
+            return &it->second;
+        return stdLib.getFunctionSignature(nameId);
+    }
+
+    // Argument passing rules: arrays decay to pointers, string literals are char*
+    bool isArgumentCompatible(uint32_t paramType, uint32_t argType)
+    {
+        if (paramType == argType)
+            return true;
+
+        uint64_t key = (uint64_t(paramType) << 32) | argType;
+        auto cached = argCompatCache.find(key);
+        if (cached != argCompatCache.end())
+            return cached->second;
+
+        StringInterner &ids = StringInterner::current();
+        string arg = FunctionSignature::normalizeType(ids.name(argType));
+        if (arg == "string")
+            arg = "char*";
+        else if (arg.size() > 2 && arg.compare(arg.size() - 2, 2, "[]") == 0)
+            arg = arg.substr(0, arg.size() - 2) + "*";
+
+        bool ok = TypeSystem::areTypesCompatible(ids.name(paramType), arg);
+        argCompatCache.emplace(key, ok);
+        return ok;
+    }
+
+    // Matches each conversion specifier of a literal format string against the variadic arguments
+    void checkFormatString(const Token &callTok, const Token &fmtTok, bool scanStyle,
+                           const vector<uint32_t> &argTypes, size_t firstVarArg)
+    {
+        vector<FormatSpec> specs = FormatStringParser::parse(fmtTok.value, scanStyle);
+        size_t arg = firstVarArg;
+
+        for (const FormatSpec &spec : specs)
+        {
+            string where = "Line " + to_string(fmtTok.line) + ":" + to_string(fmtTok.column + spec.offset);
+            string expected = FormatStringParser::expectedType(spec, scanStyle);
+            if (expected.empty())
+            {
+                errors.push_back({"Warning: " + where + " - Unknown conversion '" + spec.text + "' in format string",
+                                  "SUGGESTION: Use a valid conversion such as %d, %f, %s or %c; write %% for a literal '%'"});
+                return; // argument positions are unreliable past this point
+            }
+            if (!FormatStringParser::validLength(spec.length))
+            {
+                errors.push_back({"Warning: " + where + " - Invalid length modifier '" + spec.length + "' in format '" +
+                                      spec.text + "'",
+                                  "SUGGESTION: Use one of hh, h, l, ll, j, z, t or L"});
+                return;
+            }
+
+            // '*' width and precision each take an int argument before the value
+            for (int star = 0; star < spec.starArgs && arg < argTypes.size(); star++, arg++)
+            {
+                if (argTypes[arg] != unknownType && argTypes[arg] != functionType &&
+                    !FormatStringParser::argumentMatches("int", typeName(argTypes[arg])))
+                {
+                    errors.push_back({"Warning: " + where + " - Format '" + spec.text + "' expects 'int' for '*' but argument " +
+                                          to_string(arg + 1) + " has type '" + typeName(argTypes[arg]) + "'",
+                                      "SUGGESTION: Pass the field width or precision as an int, e.g. (int)len"});
+                }
+            }
+            if (spec.suppressed)
+                continue;
+
+            if (arg >= argTypes.size())
+            {
+                errors.push_back({"Warning: " + where + " - Format '" + spec.text + "' has no matching argument in call to '" +
+                                      callTok.value + "'",
+                                  "SUGGESTION: Pass one argument per conversion specifier"});
+                return;
+            }
+
+            const string &argType = typeName(argTypes[arg]);
+            if (argTypes[arg] != unknownType && argTypes[arg] != functionType &&
+                !FormatStringParser::argumentMatches(expected, argType))
+            {
+                errors.push_back({"Warning: " + where + " - Format '" + spec.text + "' expects '" + expected +
+                                      "' but argument " + to_string(arg + 1) + " has type '" + argType + "'",
+                                  scanStyle ? "SUGGESTION: scanf needs the address of a variable of the matching type, e.g. &x"
+                                            : "SUGGESTION: Use the conversion that matches the argument type"});
+            }
+            arg++;
+        }
+
+        if (arg < argTypes.size())
+        {
+            errors.push_back({"Warning: Line " + to_string(callTok.line) + ":" + to_string(callTok.column) +
+                                  " - Too many arguments for format in call to '" + callTok.value + "'",
+                              "SUGGESTION: Remove the extra arguments or add conversion specifiers"});
+        }
+    }
+
+    void checkCallArguments(const Token &idTok, const FunctionSignature &sig, const vector<uint32_t> &argTypes)
+    {
+        int required = sig.paramTypes.size();
+        int provided = argTypes.size();
+
+        if (sig.variadic && provided < required)
+        {
+            errors.push_back({"Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
+                                  " - Function '" + idTok.value +
+                                  "' requires at least " + to_string(required) + " argument(s)",
+                              "SUGGESTION: Provide enough parameters before the variadic '...'"});
+            return;
+        }
+        if (!sig.variadic && provided != required)
+        {
+            errors.push_back({"Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
+                                  " - Function call argument mismatch for '" + idTok.value + "'",
+                              "SUGGESTION: Expected " + to_string(required) +
+                                  " argument(s), but got " + to_string(provided)});
+            return;
+        }
+
+        for (int i = 0; i < required; i++)
+        {
+            uint32_t argType = argTypes[i];
+            if (argType == unknownType || argType == functionType)
+                continue;
+
+            uint32_t paramType = sig.paramTypes[i];
+            if (!isArgumentCompatible(paramType, argType))
+            {
+                string errMsg = "Warning: Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
+                                " - Argument " + to_string(i + 1) + " of '" + idTok.value + "' has type '" +
+                                typeName(argType) + "' but parameter expects '" + typeName(paramType) + "'";
+                errors.push_back({errMsg, "SUGGESTION: Pass a value of the parameter's type or cast it explicitly"});
+            }
+        }
+    }
+
+    void parseBlock()
+    {
+        size_t maxIter = tokens.size() + 1; // every iteration consumes at least one token
+        size_t iter = 0;
+        while (curr().type != TokenType::RBRACE && curr().type != TokenType::TOK_EOF && iter++ < maxIter)
+        {
+            lastIndex = index;
+            if (isTypeToken(curr()) || isStorageClass(curr()))
+            {
+                countStatement();
+                parseDeclOrFunc();
+            }
+            else
+                parseStatement();
+            forceAdvance();
+        }
+
+        if (iter >= maxIter)
+        {
+            Token bad = curr();
+            string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Parser stuck, aborting block";
+            errors.push_back({errMsg, ""});
+        }
+        expect(TokenType::RBRACE, "}");
+    }
+
+    // factor typedef into a reusable routine
+    void parseTypedef()
+    {
+        advance(); // consumed KW_TYPEDEF
+
+        if (!isTypeToken(curr()))
+        {
+            Token bad = curr();
+            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                         " - Expected type after typedef";
+            errors.push_back({err, "SUGGESTION: typedef <existing_type> <new_name>;"});
+            return;
+        }
+
+        string baseType = typeSpelling(curr());
+        advance();
+
+        // typedef struct Point ...
+        if (baseType == "struct")
+        {
+            if (isTagToken(curr()))
+            {
+                baseType += " " + curr().value;
+                advance();
+            }
+        }
+
+        baseType += parsePointerStars();
+
+        if (!isTagToken(curr())) // a repeated typedef re-tags its own name
+        {
+            Token bad = curr();
+            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                         " - Expected new type name in typedef";
+            errors.push_back({err, "SUGGESTION: Provide name for the new type"});
+            return;
+        }
+
+        string newTypeName = curr().value;
+        advance();
+        expect(TokenType::SEMICOLON, ";");
+
+        rebindTypedef(newTypeName, baseType);
+    }
+
+    // ---- integer constant expressions (array sizes, enumerators, #define bodies) ----
+
+    // Binding power of binary operators in constant expressions, 0 = not one
+    static int constPrecedence(TokenType t)
+    {
+        switch (t)
+        {
+        case TokenType::OP_STAR:
+        case TokenType::OP_SLASH:
+        case TokenType::OP_PERCENT:
+            return 10;
+        case TokenType::OP_PLUS:
+        case TokenType::OP_MINUS:
+            return 9;
+        case TokenType::OP_SHL:
+        case TokenType::OP_SHR:
+            return 8;
+        case TokenType::OP_LT:
+        case TokenType::OP_GT:
+        case TokenType::OP_LE:
+        case TokenType::OP_GE:
+            return 7;
+        case TokenType::OP_EQ:
+        case TokenType::OP_NE:
+            return 6;
+        case TokenType::OP_BITAND:
+            return 5;
+        case TokenType::OP_BITXOR:
+            return 4;
+        case TokenType::OP_BITOR:
+            return 3;
+        case TokenType::OP_AND:
+            return 2;
+        case TokenType::OP_OR:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+
+    // Why applyConstOp refused op: only faults the program itself makes are reported
+    static pair<string, string> constOpFault(TokenType op, int64_t rhs)
+    {
+        if ((op == TokenType::OP_SLASH || op == TokenType::OP_PERCENT) && rhs == 0)
+            return {"Division by zero in constant expression", "SUGGESTION: The divisor of a constant must not be zero"};
+        if ((op == TokenType::OP_SHL || op == TokenType::OP_SHR) && (rhs < 0 || rhs >= 64))
+            return {"Shift count " + to_string(rhs) + " in constant expression is out of range",
+                    "SUGGESTION: Shift by at least 0 and less than the width of the operand"};
+        return {};
+    }
+
+    // Wrapping arithmetic so overflowing constants never hit undefined behaviour
+    static bool applyConstOp(TokenType op, int64_t &lhs, int64_t rhs)
+    {
+        uint64_t a = uint64_t(lhs), b = uint64_t(rhs);
+        switch (op)
+        {
+        case TokenType::OP_STAR:
+            lhs = int64_t(a * b);
+            return true;
+        case TokenType::OP_SLASH:
+        case TokenType::OP_PERCENT:
+            if (rhs == 0 || (lhs == INT64_MIN && rhs == -1))
+                return false;
+            lhs = op == TokenType::OP_SLASH ? lhs / rhs : lhs % rhs;
+            return true;
+        case TokenType::OP_PLUS:
+            lhs = int64_t(a + b);
+            return true;
+        case TokenType::OP_MINUS:
+            lhs = int64_t(a - b);
+            return true;
+        case TokenType::OP_SHL:
+        case TokenType::OP_SHR:
+            if (rhs < 0 || rhs >= 64)
+                return false;
+            lhs = op == TokenType::OP_SHL ? int64_t(a << rhs) : lhs >> rhs;
+            return true;
+        case TokenType::OP_LT:
+            lhs = lhs < rhs;
+            return true;
+        case TokenType::OP_GT:
+            lhs = lhs > rhs;
+            return true;
+        case TokenType::OP_LE:
+            lhs = lhs <= rhs;
+            return true;
+        case TokenType::OP_GE:
+            lhs = lhs >= rhs;
+            return true;
+        case TokenType::OP_EQ:
+            lhs = lhs == rhs;
+            return true;
+        case TokenType::OP_NE:
+            lhs = lhs != rhs;
+            return true;
+        case TokenType::OP_BITAND:
+            lhs = lhs & rhs;
+            return true;
+        case TokenType::OP_BITXOR:
+            lhs = lhs ^ rhs;
+            return true;
+        case TokenType::OP_BITOR:
+            lhs = lhs | rhs;
+            return true;
+        case TokenType::OP_AND:
+            lhs = lhs && rhs;
+            return true;
+        case TokenType::OP_OR:
+            lhs = lhs || rhs;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static bool charLiteralValue(const string &lit, int64_t &out)
+    {
+        if (lit.size() == 3)
+        {
+            out = (unsigned char)lit[1];
+            return true;
+        }
+        if (lit.size() == 4 && lit[1] == '\\')
+        {
+            static const char escapes[] = "n\nt\tr\r0\0\\\\''\"\"a\ab\bf\fv\v"; // pairs, may hold '\0'
+            for (size_t e = 0; e + 1 < sizeof(escapes) - 1; e += 2)
+                if (escapes[e] == lit[2])
+                {
+                    out = (unsigned char)escapes[e + 1];
+                    return true;
+                }
+        }
+        return false;
+    }
+
+    // Storage size on the target, -1 when unknown
+    int64_t sizeOfType(const string &type)
+    {
+        int64_t size, align;
+        return layoutOf(type, size, align) ? size : -1;
+    }
+
+    bool layoutOf(const string &type, int64_t &size, int64_t &align)
+    {
+        string t = resolveType(type);
+        if (TypeSystem::isPointer(t))
+            return abi->find("*", size, align);
+        if (!TypeSystem::isStruct(t))
+            return abi->find(t, size, align);
+        const StructLayout &l = structLayout(t);
+        size = l.size, align = l.align;
+        return size >= 0;
+    }
+
+    // Size and alignment of one member; false when unknown (flexible arrays, incomplete types)
+    bool fieldLayout(const StructField &f, int64_t &size, int64_t &align)
+    {
+        bool isArray = f.type.size() > 2 && f.type.compare(f.type.size() - 2, 2, "[]") == 0;
+        if (isArray && f.length < 0)
+            return false;
+        if (!layoutOf(isArray ? f.type.substr(0, f.type.size() - 2) : f.type, size, align))
+            return false;
+        if (isArray)
+            size *= f.length;
+        return true;
+    }
+
+    // Struct size with the members placed in the given order at their natural alignment
+    static int64_t placeFields(const vector<int64_t> &sizes, const vector<int64_t> &aligns,
+                               const vector<size_t> &order, int64_t structAlign, vector<int64_t> *offsets)
+    {
+        int64_t at = 0;
+        for (size_t i : order)
+        {
+            at = (at + aligns[i] - 1) / aligns[i] * aligns[i];
+            if (offsets)
+                (*offsets)[i] = at;
+            at += sizes[i];
+        }
+        return (at + structAlign - 1) / structAlign * structAlign;
+    }
+
+    // Member indices by decreasing alignment: no holes between scalar members
+    static vector<size_t> alignmentOrder(const vector<int64_t> &aligns)
+    {
+        vector<size_t> order(aligns.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                    { return aligns[a] > aligns[b]; });
+        return order;
+    }
+
+    bool fieldLayouts(const vector<StructField> &fields, vector<int64_t> &sizes, vector<int64_t> &aligns)
+    {
+        sizes.resize(fields.size());
+        aligns.resize(fields.size());
+        for (size_t i = 0; i < fields.size(); i++)
+            if (!fieldLayout(fields[i], sizes[i], aligns[i]))
+                return false;
+        return !fields.empty();
+    }
+
+    // Memoized, so a struct embedded in many others is laid out once; one that
+    // contains itself stays unknown (size -1) instead of recursing
+    const StructLayout &structLayout(const string &name)
+    {
+        auto memo = layouts.find(name);
+        if (memo != layouts.end())
+            return memo->second;
+        layouts[name].size = -1;
+
+        StructLayout l;
+        l.name = name;
+        l.size = -1;
+        vector<int64_t> sizes, aligns;
+        auto def = structFields.find(name);
+        if (def != structFields.end() && fieldLayouts(def->second, sizes, aligns))
+        {
+            const vector<StructField> &fields = def->second;
+            l.line = fields[0].name.line;
+            l.align = *max_element(aligns.begin(), aligns.end());
+
+            vector<size_t> order(fields.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            vector<int64_t> offsets(fields.size());
+            l.size = placeFields(sizes, aligns, order, l.align, &offsets);
+            l.padding = l.size;
+            for (int64_t size : sizes)
+                l.padding -= size;
+            l.optimalSize = placeFields(sizes, aligns, alignmentOrder(aligns), l.align, nullptr);
+
+            int64_t line = abi->cacheLine;
+            for (size_t i = 0; i < fields.size(); i++)
+                if (sizes[i] > 0 && sizes[i] <= line && offsets[i] / line != (offsets[i] + sizes[i] - 1) / line)
+                    l.straddling.push_back(fields[i].name.value);
+        }
+        return layouts[name] = l;
+    }
+
+    // After a struct definition: padding a reordering would remove, members split across cache lines
+    void reportLayout(const string &name, const Token &tagTok)
+    {
+        const StructLayout &l = structLayout(name);
+        if (l.size < 0)
+            return;
+        StructLayout defined = l;
+        defined.line = tagTok.line;
+        definedLayouts.push_back(defined);
+
+        if constexpr (Policy::layoutChecks)
+        {
+            const vector<StructField> &fields = structFields[name];
+            string at = "Warning: Line " + to_string(tagTok.line) + ":" + to_string(tagTok.column) + " - ";
+            int64_t line = abi->cacheLine;
+            if (l.optimalSize < l.size)
+            {
+                vector<int64_t> sizes, aligns;
+                fieldLayouts(fields, sizes, aligns);
+                string order;
+                for (size_t i : alignmentOrder(aligns))
+                    order += (order.empty() ? "" : ", ") + fields[i].name.value;
+
+                string msg = at + name + " is " + to_string(l.size) + " bytes with " + to_string(l.padding) +
+                             " bytes of padding; ordering members by alignment makes it " + to_string(l.optimalSize);
+                if (l.size <= line && line / l.optimalSize != line / l.size) // only when more fit per line
+                    msg += " (" + to_string(line / l.optimalSize) + " per " + to_string(line) + "-byte cache line instead of " +
+                           to_string(line / l.size) + ")";
+                errors.push_back({msg, "SUGGESTION: Declare the members in this order: " + order});
+            }
+            for (const string &member : l.straddling)
+                errors.push_back({at + "Member '" + member + "' of " + name + " straddles a " + to_string(line) +
+                                      "-byte cache line",
+                                  "SUGGESTION: Reorder or pad the members so '" + member + "' starts a new cache line"});
+        }
+    }
+
+    // Type keywords plus typedef names in token lists the parser has not tagged (macro bodies)
+    bool isConstTypeToken(const Token &t) const
+    {
+        return isTypeToken(t) || (t.type == TokenType::TOK_IDENTIFIER && typedefs.count(t.value));
+    }
+
+    // type-name in a cast or sizeof inside a folded expression; -1 size when unknown
+    bool foldTypeName(const vector<Token> &toks, size_t &i, size_t end, string &type)
+    {
+        if (i >= end || !isConstTypeToken(toks[i]))
+            return false;
+        const Token &base = toks[i++];
+        bool typedefName = base.type == TokenType::TYPEDEF_NAME || base.type == TokenType::TOK_IDENTIFIER;
+        type = typedefName ? typedefs.at(base.value) : base.value;
+        foldUsesScope = foldUsesScope || typedefName;
+        if ((type == "struct" || type == "enum") && i < end && isTagToken(toks[i]))
+            type = type == "enum" ? "int" : "struct " + toks[i++].value;
+        while (i < end && (toks[i].type == TokenType::OP_STAR || toks[i].type == TokenType::KW_CONST))
+            type += toks[i++].type == TokenType::OP_STAR ? "*" : "";
+        return i < end && toks[i].type == TokenType::RPAREN;
+    }
+
+    // sizeof(type), sizeof(var), sizeof(var[0]), sizeof *p
+    bool foldSizeof(const vector<Token> &toks, size_t &i, size_t end, int64_t &out)
+    {
+        bool paren = i < end && toks[i].type == TokenType::LPAREN;
+        size_t j = i + (paren ? 1 : 0);
+        string type;
+        int64_t length = -1;
+
+        if (j < end && isConstTypeToken(toks[j]))
+        {
+            if (!paren || !foldTypeName(toks, j, end, type))
+                return false;
+        }
+        else
+        {
+            int derefs = 0;
+            while (j < end && toks[j].type == TokenType::OP_STAR)
+                derefs++, j++;
+            if (j >= end || toks[j].type != TokenType::TOK_IDENTIFIER)
+                return false;
+            VarInfo *v = sym.lookup(toks[j++].value);
+            foldUsesScope = true;
+            if (!v)
+                return false;
+            type = resolveType(v->type);
+            length = v->arrayLength;
+
+            while (j < end && toks[j].type == TokenType::LBRACKET) // var[...] - the index is irrelevant
+            {
+                int depth = 0;
+                do
+                {
+                    depth += toks[j].type == TokenType::LBRACKET ? 1 : toks[j].type == TokenType::RBRACKET ? -1 : 0;
+                    j++;
+                } while (j < end && depth > 0);
+                derefs++;
+            }
+            for (; derefs > 0; derefs--)
+            {
+                if (type.size() > 2 && type.compare(type.size() - 2, 2, "[]") == 0)
+                    type.resize(type.size() - 2), length = -1;
+                else if (TypeSystem::isPointer(type))
+                    type = TypeSystem::basePointerType(type);
+                else
+                    return false;
+            }
+        }
+        if (paren)
+        {
+            if (j >= end || toks[j].type != TokenType::RPAREN)
+                return false;
+            j++;
+        }
+        i = j;
+
+        if (type.size() > 2 && type.compare(type.size() - 2, 2, "[]") == 0)
+        {
+            int64_t element = sizeOfType(type.substr(0, type.size() - 2));
+            if (length < 0 || element < 0)
+                return false;
+            out = length * element;
+            return true;
+        }
+        out = sizeOfType(type);
+        return out >= 0;
+    }
+
+    void noteConstFault(const pair<string, string> &fault)
+    {
+        if (!fault.first.empty() && unevaluatedFold == 0 && constFault.first.empty())
+            constFault = fault;
+    }
+
+    // Enumerators, then #define bodies, folded once and memoized. A body that looked
+    // up a variable or typedef (sizeof(buf)) means whatever is in scope at each use,
+    // so it is folded again every time
+    bool constantValue(const string &name, int64_t &out)
+    {
+        auto e = enumConstants.find(name);
+        if (e != enumConstants.end())
+        {
+            out = e->second;
+            return true;
+        }
+        auto m = macros.find(name);
+        if (m == macros.end())
+            return false;
+        MacroConstant &macro = m->second;
+        typename MacroConstant::State state = macro.state;
+        if (state == MacroConstant::Pending)
+        {
+            bool outerScoped = exchange(foldUsesScope, false);
+            int outerUnevaluated = exchange(unevaluatedFold, 0);
+            pair<string, string> outerFault = exchange(constFault, {});
+
+            macro.state = MacroConstant::Evaluating; // #define A A must not recurse forever
+            size_t i = 0;
+            bool ok = foldConstant(macro.body, i, macro.body.size(), 0, macro.value) && i == macro.body.size();
+            state = ok ? MacroConstant::Done : MacroConstant::NotConstant;
+            macro.fault = ok ? pair<string, string>() : constFault;
+            macro.state = foldUsesScope ? MacroConstant::Pending : state;
+            if (!foldUsesScope)
+                macro.body.clear();
+
+            foldUsesScope = foldUsesScope || outerScoped;
+            unevaluatedFold = outerUnevaluated;
+            constFault = move(outerFault);
+        }
+        if (state != MacroConstant::Done)
+            noteConstFault(macro.fault);
+        out = macro.value;
+        return state == MacroConstant::Done;
+    }
+
+    bool foldUnary(const vector<Token> &toks, size_t &i, size_t end, int64_t &out)
+    {
+        if (i >= end)
+            return false;
+        const Token &t = toks[i++];
+        switch (t.type)
+        {
+        case TokenType::TOK_NUMBER:
+            out = int64_t(t.intValue);
+            return !(t.numFlags & NUM_FLOAT);
+        case TokenType::TOK_CHAR:
+            return charLiteralValue(t.value, out);
+        case TokenType::TOK_IDENTIFIER:
+            return constantValue(t.value, out);
+        case TokenType::KW_SIZEOF:
+            return foldSizeof(toks, i, end, out);
+        case TokenType::OP_PLUS:
+            return foldUnary(toks, i, end, out);
+        case TokenType::OP_MINUS:
+            if (!foldUnary(toks, i, end, out))
+                return false;
+            out = int64_t(0 - uint64_t(out));
+            return true;
+        case TokenType::OP_BITNOT:
+            if (!foldUnary(toks, i, end, out))
+                return false;
+            out = ~out;
+            return true;
+        case TokenType::OP_NOT:
+            if (!foldUnary(toks, i, end, out))
+                return false;
+            out = !out;
+            return true;
+        case TokenType::LPAREN:
+        {
+            string castType;
+            size_t j = i;
+            if (foldTypeName(toks, j, end, castType)) // (int)N: integer casts keep the value
+            {
+                i = j + 1;
+                return (TypeSystem::isInteger(castType) || TypeSystem::isChar(castType)) && foldUnary(toks, i, end, out);
+            }
+            if (!foldConstant(toks, i, end, 0, out) || i >= end || toks[i].type != TokenType::RPAREN)
+                return false;
+            i++;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // Precedence climbing over toks[i, end); false when it is not an integer constant
+    bool foldConstant(const vector<Token> &toks, size_t &i, size_t end, int minPrec, int64_t &out)
+    {
+        if (!foldUnary(toks, i, end, out))
+            return false;
+        while (i < end)
+        {
+            TokenType op = toks[i].type;
+            if (op == TokenType::QUESTION && minPrec == 0)
+            {
+                int64_t a, b;
+                bool taken = out != 0;
+                i++;
+                unevaluatedFold += !taken;
+                bool ok = foldConstant(toks, i, end, 0, a);
+                unevaluatedFold -= !taken;
+                if (!ok || i >= end || toks[i].type != TokenType::COLON)
+                    return false;
+                i++;
+                unevaluatedFold += taken;
+                ok = foldConstant(toks, i, end, 0, b);
+                unevaluatedFold -= taken;
+                if (!ok)
+                    return false;
+                out = taken ? a : b;
+                continue;
+            }
+            int prec = constPrecedence(op);
+            if (prec == 0 || prec < minPrec)
+                return true;
+            i++;
+            int64_t rhs;
+            bool skipped = (op == TokenType::OP_AND && !out) || (op == TokenType::OP_OR && out);
+            unevaluatedFold += skipped;
+            bool ok = foldConstant(toks, i, end, prec + 1, rhs);
+            unevaluatedFold -= skipped;
+            if (!ok)
+                return false;
+            if (!applyConstOp(op, out, rhs))
+            {
+                noteConstFault(constOpFault(op, rhs));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The tokens [first, last) the parser just consumed, as an integer constant
+    bool evaluateConstant(size_t first, size_t last, int64_t &out)
+    {
+        size_t i = first;
+        constFault = {};
+        return foldConstant(tokens, i, last, 0, out) && i == last;
+    }
+
+    // After a failed evaluateConstant: reports a division by zero or bad shift in it
+    bool reportConstFault(size_t first)
+    {
+        if (constFault.first.empty())
+            return false;
+        string errMsg = "Line " + to_string(tokens[first].line) + ":" + to_string(tokens[first].column) + " - " +
+                        constFault.first;
+        errors.push_back({errMsg, constFault.second});
+        return true;
+    }
+
+    // '[' [size] ']' after a declarator name; the element count, or -1 when the
+    // size is omitted or not a constant (a VLA)
+    int64_t parseArrayDeclarator(const Token &nameTok)
+    {
+        advance(); // '['
+        int64_t length = -1;
+        if (curr().type != TokenType::RBRACKET)
+        {
+            size_t first = index;
+            parseExpressionWithFullType();
+            int64_t value;
+            bool constant = evaluateConstant(first, index, value);
+            if constexpr (Policy::typeChecks)
+            {
+                if (!constant)
+                    reportConstFault(first);
+            }
+            if (constant)
+            {
+                length = value;
+                if constexpr (Policy::typeChecks)
+                {
+                    if (value < 0)
+                    {
+                        string errMsg = "Line " + to_string(tokens[first].line) + ":" + to_string(tokens[first].column) +
+                                        " - Size of array '" + nameTok.value + "' is negative (" + to_string(value) + ")";
+                        errors.push_back({errMsg, "SUGGESTION: Array sizes must be positive constants"});
+                    }
+                }
+            }
+        }
+        expect(TokenType::RBRACKET, "]");
+        return length;
+    }
+
+    // Object-like #define NAME body: NAME becomes a known identifier and its body a
+    // constant folded on first use. Function-like macros are called like functions
+    void parsePreprocessor()
+    {
+        string text = curr().value;
+        preprocessor.processPreprocessor(text, curr().line);
+        advance();
+
+        size_t p = text.find_first_not_of(" \t", 1);
+        if (p == string::npos || text.compare(p, 6, "define") != 0)
+            return;
+        p = text.find_first_not_of(" \t", p + 6);
+        size_t nameEnd = p;
+        while (nameEnd < text.size() && (isalnum((unsigned char)text[nameEnd]) || text[nameEnd] == '_'))
+            nameEnd++;
+        if (p == string::npos || nameEnd == p)
+            return;
+        string name = text.substr(p, nameEnd - p);
+
+        if (nameEnd < text.size() && text[nameEnd] == '(')
+        {
+            sym.declare(name, "function");
+            return;
+        }
+        MacroConstant &macro = macros[name];
+        macro = MacroConstant();
+        string body = text.substr(nameEnd);
+        macro.body = Lexer(body).tokenizeAll();
+        macro.body.pop_back(); // TOK_EOF
+        sym.declare(name, "UNKNOWN"); // the body may not be an integer at all
+    }
+
+    // enum [Tag] [{ A, B = 4, C }] [declarator];  enumerators are int constants
+    void parseEnum()
+    {
+        advance(); // consumed KW_ENUM
+        if (isTagToken(curr()))
+            advance();
+
+        if (curr().type == TokenType::LBRACE)
+        {
+            advance();
+            int64_t next = 0;
+            while (curr().type != TokenType::RBRACE && curr().type != TokenType::TOK_EOF)
+            {
+                if (curr().type != TokenType::TOK_IDENTIFIER)
+                {
+                    Token bad = curr();
+                    string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                 " - Expected enumerator name";
+                    errors.push_back({err, "SUGGESTION: enum <name> { A, B = 2, C };"});
+                    break;
+                }
+                Token nameTok = curr();
+                advance();
+
+                if (curr().type == TokenType::OP_ASSIGN)
+                {
+                    advance();
+                    size_t first = index;
+                    parseExpressionWithFullType();
+                    int64_t value;
+                    if (evaluateConstant(first, index, value))
+                        next = value;
+                    else if constexpr (Policy::typeChecks)
+                    {
+                        if (!reportConstFault(first))
+                        {
+                            string err = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                                         " - Enumerator value for '" + nameTok.value + "' is not an integer constant";
+                            errors.push_back({err, "SUGGESTION: Use literals, other enumerators or #define constants"});
+                        }
+                    }
+                }
+
+                if (!sym.declare(nameTok.value, "int", nameTok.line, nameTok.column))
+                {
+                    string err = "Line " + to_string(nameTok.line) + ":" + to_string(nameTok.column) +
+                                 " - Redeclaration of '" + nameTok.value + "'";
+                    errors.push_back({err, suggestionEngine.getSuggestion(err)});
+                }
+                enumConstants[nameTok.value] = next++;
+
+                if (curr().type != TokenType::COMMA)
+                    break;
+                advance();
+            }
+            expect(TokenType::RBRACE, "}");
+        }
+
+        if (curr().type == TokenType::SEMICOLON)
+        {
+            advance();
+            return;
+        }
+
+        // enum Color c = RED;  enum Color pick(void) { ... }
+        string type = "int" + parsePointerStars();
+        if (curr().type != TokenType::TOK_IDENTIFIER)
+        {
+            Token bad = curr();
+            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                         " - Expected identifier after enum type";
+            errors.push_back({err, "SUGGESTION: enum <name> <variable>;"});
+            return;
+        }
+        Token nameTok = curr();
+        advance();
+        if (curr().type == TokenType::LPAREN)
+            parseFunction(type, nameTok.value, nameTok);
+        else
+            parseVarDecl(type, nameTok.value, nameTok);
+    }
+
+    // factor struct into a reusable routine
+    void parseStruct()
+    {
+        advance(); // consumed KW_STRUCT
+
+        if (!isTagToken(curr()))
+        {
+            Token bad = curr();
+            string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                         " - Expected struct name";
+            errors.push_back({err, "SUGGESTION: struct <name> { ... } or struct <name> <variable>;"});
+            return;
+        }
+
+        string structName = curr().value;
+        Token tagTok = curr();
+        advance();
+
+        // struct <name> { ... } [opt var] ;
+        if (curr().type == TokenType::LBRACE)
+        {
+            advance();
+            auto &members = structMembers["struct " + structName];
+            auto &fields = structFields["struct " + structName];
+            fields.clear();
+            layouts.erase("struct " + structName);
+            bool complete = true; // every member declaration parsed
+            while (curr().type != TokenType::RBRACE && curr().type != TokenType::TOK_EOF)
+            {
+                if (isTypeToken(curr()))
+                {
+                    string memberType = typeSpelling(curr());
+                    advance();
+
+                    // struct Other inner;
+                    if (memberType == "struct" && isTagToken(curr()))
+                    {
+                        memberType += " " + curr().value;
+                        advance();
+                    }
+                    else if (memberType == "enum")
+                    {
+                        memberType = "int";
+                        if (isTagToken(curr()))
+                            advance();
+                    }
+
+                    // int x, *next, buf[8];
+                    bool named = true;
+                    while (true)
+                    {
+                        string declType = memberType + parsePointerStars();
+                        if (curr().type != TokenType::TOK_IDENTIFIER)
+                        {
+                            named = false;
+                            break;
+                        }
+                        Token memberTok = curr();
+                        advance();
+                        int64_t length = -1;
+                        if (curr().type == TokenType::LBRACKET)
+                        {
+                            length = parseArrayDeclarator(memberTok);
+                            declType += "[]";
+                        }
+                        members[memberTok.value] = declType;
+                        fields.push_back({memberTok, declType, length});
+                        if (curr().type != TokenType::COMMA)
+                            break;
+                        advance();
+                    }
+
+                    if (named)
+                    {
+                        expect(TokenType::SEMICOLON, ";");
+                    }
+                    else
+                    {
+                        Token bad = curr();
+                        string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                     " - Expected member name in struct";
+                        errors.push_back({err, ""});
+                        advance();
+                        complete = false;
+                    }
+                }
+                else
+                {
+                    Token bad = curr();
+                    string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                 " - Expected type in struct member";
+                    errors.push_back({err, ""});
+                    advance();
+                    complete = false;
+                }
+            }
+            expect(TokenType::RBRACE, "}");
+            if (!complete) // 'long big;': a member of unknown size leaves the layout unknown
+                fields.clear();
+            reportLayout("struct " + structName, tagTok);
+
+            // Either just a definition ...
+            if (curr().type == TokenType::SEMICOLON)
+            {
+                advance();
+            }
+            // ... or an inline variable: struct N { ... } v;
+            else if (curr().type == TokenType::TOK_IDENTIFIER || curr().type == TokenType::OP_STAR)
+            {
+                // allow pointer before name: struct N {..} *p;
+                string varType = "struct " + structName;
+
+                varType += parsePointerStars();
+
+                Token nameTok = curr();
+                if (nameTok.type == TokenType::TOK_IDENTIFIER)
+                {
+                    advance();
+                    parseVarDecl(varType, nameTok.value, nameTok);
+                    return;
+                }
+                else
+                {
+                    string err = "Line " + to_string(curr().line) + ":" + to_string(curr().column) +
+                                 " - Expected variable name after struct definition";
+                    errors.push_back({err, "SUGGESTION: struct " + structName + " { ... } var;"});
+                }
+            }
+            else
+            {
+                string err = "Line " + to_string(curr().line) + ":" + to_string(curr().column) +
+                             " - Expected ';' or variable after struct definition";
+                errors.push_back({err, "SUGGESTION: struct " + structName + " { ... }; or struct " + structName + " var;"});
+            }
+
+            sym.declare(structName, "struct_type");
+            return;
+        }
+
+        // struct <name> <declarator>...;
+        if (curr().type == TokenType::OP_STAR || curr().type == TokenType::TOK_IDENTIFIER)
+        {
+            // allow pointer stars before identifier: struct Point *p;
+            string varType = "struct " + structName;
+
+            varType += parsePointerStars();
+
+            if (curr().type == TokenType::TOK_IDENTIFIER)
+            {
+                Token nameTok = curr();
+                advance();
+                parseVarDecl(varType, nameTok.value, nameTok);
+                return;
+            }
+        }
+
+        // forward decl: struct Point;
+        if (curr().type == TokenType::SEMICOLON)
+        {
+            advance();
+            sym.declare(structName, "struct_forward");
+            return;
+        }
+
+        Token bad = curr();
+        string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Invalid struct syntax";
+        errors.push_back({err, "SUGGESTION: struct <name> { ... }; or struct <name> <var>;"});
+    }
+
+    // Handles "if (...)" statement logic
+    void parseIf()
+    {
+        Token ifTok = curr();
+        advance(); // KW_IF
+        expect(TokenType::LPAREN, "(");
+        size_t condFirst = index;
+        parseExpression();
+        recordNode(NodeKind::Condition, condFirst, condFirst, index, "if");
+        expect(TokenType::RPAREN, ")");
+
+        uint32_t condBlock = flowBlock;
+        flowBlock = flowNewBlock();
+        flowEdge(condBlock, flowBlock);
+        countDecision();
+        enterNesting();
+
+        if (curr().type == TokenType::SEMICOLON)
+        {
+            string errMsg = "Line " + to_string(ifTok.line) + ":" + to_string(ifTok.column) +
+                            " - Missing statement after 'if' condition";
+            string sug = "SUGGESTION: Add a statement or block after if";
+            errors.push_back({errMsg, sug});
+            advance();
+        }
+        else if (curr().type == TokenType::RBRACE || curr().type == TokenType::TOK_EOF)
+        {
+            string errMsg = "Line " + to_string(ifTok.line) + ":" + to_string(ifTok.column) +
+                            " - Missing statement after 'if' condition";
+            string sug = "SUGGESTION: Add a statement or block after if";
+            errors.push_back({errMsg, sug});
+        }
+        else
+        {
+            parseStatement();
+        }
+        correctKeywordTypo(); // esle { ... }
+
+        uint32_t thenEnd = flowBlock;
+        uint32_t join = flowNewBlock();
+        if (curr().type == TokenType::KW_ELSE)
+        {
+            advance();
+            flowBlock = flowNewBlock();
+            flowEdge(condBlock, flowBlock);
+            bool elseIf = curr().type == TokenType::KW_IF;
+            if (elseIf)
+                nestingDepth--; // else-if chains stay at one level
+            parseStatement();
+            if (elseIf)
+                nestingDepth++;
+            flowEdge(flowBlock, join);
+        }
+        else
+        {
+            flowEdge(condBlock, join);
+        }
+        flowEdge(thenEnd, join);
+        flowBlock = join;
+        nestingDepth--;
+    }
+
+    // Handles "while (...)" and "for (init; cond; step)" statement logic
+    void parseLoop()
+    {
+        Token loopTok = curr();
+        size_t loopIndex = index;
+        bool isFor = loopTok.type == TokenType::KW_FOR;
+        advance(); // KW_WHILE or KW_FOR
+        expect(TokenType::LPAREN, "(");
+
+        if (isFor)
+        {
+            openScope(); // for (int i = 0; ...) is scoped to the loop
+            if (isTypeToken(curr()))
+            {
+                string type = typeSpelling(curr());
+                advance();
+                type += parsePointerStars();
+                if (curr().type == TokenType::TOK_IDENTIFIER)
+                {
+                    Token nameTok = curr();
+                    advance();
+                    parseVarDecl(type, nameTok.value, nameTok); // consumes the ';'
+                }
+                else
+                {
+                    expect(TokenType::TOK_IDENTIFIER, "identifier");
+                }
+            }
+            else
+            {
+                if (curr().type != TokenType::SEMICOLON)
+                    parseExprOrAssignment();
+                expect(TokenType::SEMICOLON, ";");
+            }
+        }
+
+        uint32_t header = flowNewBlock();
+        flowEdge(flowBlock, header);
+        flowBlock = header;
+
+        uint32_t step = header;
+        size_t condFirst = index;
+        if (isFor)
+        {
+            if (curr().type != TokenType::SEMICOLON)
+                parseExpression();
+            recordNode(NodeKind::Condition, condFirst, condFirst, index, "for");
+            expect(TokenType::SEMICOLON, ";");
+
+            // the step runs after the body, so its events go to their own block
+            step = flowNewBlock();
+            flowBlock = step;
+            if (curr().type != TokenType::RPAREN)
+                parseExprOrAssignment();
+            flowEdge(step, header);
+        }
+        else
+        {
+            parseExpression();
+            recordNode(NodeKind::Condition, condFirst, condFirst, index, "while");
+        }
+        expect(TokenType::RPAREN, ")");
+
+        uint32_t body = flowNewBlock();
+        uint32_t exit = flowNewBlock();
+        flowEdge(header, body);
+        flowEdge(header, exit);
+        flowBlock = body;
+        loopTargets.push_back({step, exit});
+        countDecision();
+        enterNesting();
+
+        if (curr().type == TokenType::SEMICOLON)
+        {
+            string errMsg = "Line " + to_string(loopTok.line) + ":" + to_string(loopTok.column) +
+                            " - Missing statement after loop condition";
+            string sug = "SUGGESTION: Add a statement or block";
+            errors.push_back({errMsg, sug});
+            advance();
+        }
+        else
+        {
+            parseStatement();
+        }
+
+        nestingDepth--;
+        recordNode(NodeKind::Loop, loopIndex, loopIndex, index, loopTok.value);
+        loopTargets.pop_back();
+        flowEdge(flowBlock, step);
+        flowBlock = exit;
+        if (isFor)
+            closeScope();
+    }
+
+    void parseStatement()
+    {
+        correctKeywordTypo();
+        Token t = curr();
+
+        // Handle preprocessor
+        if (t.type == TokenType::PREPROCESSOR)
+        {
+            parsePreprocessor();
+            return;
+        }
+
+        // Handle block
+        if (t.type == TokenType::LBRACE)
+        {
+            advance();
+            openScope();
+            parseBlock();
+            closeScope();
+            return;
+        }
+
+        countStatement();
+
+        // Handle control flow
+        if (t.type == TokenType::KW_IF)
+        {
+            parseIf();
+            return;
+        }
+
+        if (t.type == TokenType::KW_WHILE || t.type == TokenType::KW_FOR)
+        {
+            parseLoop();
+            return;
+        }
+
+        if (t.type == TokenType::KW_RETURN)
+        {
+            size_t returnIndex = index;
+            advance();
+            if (curr().type != TokenType::SEMICOLON)
+                parseExpressionWithFullType();
+            expect(TokenType::SEMICOLON, ";");
+            recordNode(NodeKind::Return, returnIndex, returnIndex, index);
+            flowEdge(flowBlock, FunctionFlowGraph::EXIT);
+            flowBlock = flowNewBlock(); // anything after is unreachable
+            return;
+        }
+
+        if (t.type == TokenType::KW_BREAK || t.type == TokenType::KW_CONTINUE)
+        {
+            advance();
+            if (loopTargets.empty())
+            {
+                string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                                " - '" + t.value + "' statement not within a loop";
+                errors.push_back({errMsg, "SUGGESTION: Use '" + t.value + "' only inside while or for loops"});
+            }
+            else
+            {
+                flowEdge(flowBlock, t.type == TokenType::KW_BREAK ? loopTargets.back().second
+                                                                   : loopTargets.back().first);
+                flowBlock = flowNewBlock();
+            }
+            expect(TokenType::SEMICOLON, ";");
+            return;
+        }
+
+        if (t.type == TokenType::SEMICOLON)
+        {
+            advance();
+            return;
+        }
+
+        // ============================================================================
+        // Handle typedef: typedef int MyInt; typedef struct Point MyPoint;
+        // ============================================================================
+        // Inside parseStatement()
+        if (t.type == TokenType::KW_TYPEDEF)
+        {
+            parseTypedef();
+            return;
+        }
+        // ============================================================================
+        // Handle const keyword at statement start: const int x = 5;
+        // ============================================================================
+        if (t.type == TokenType::KW_CONST)
+        {
+            advance();
+
+            if (!isTypeToken(curr()))
+            {
+                Token bad = curr();
+                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                " - Expected type after const";
+                string sug = "SUGGESTION: const <type> <variable_name>;";
+                errors.push_back({errMsg, sug});
+                return;
+            }
+
+            string type = "const " + typeSpelling(curr());
+            advance();
+
+            // Handle pointers: const int *p;
+            type += parsePointerStars();
+
+            if (curr().type != TokenType::TOK_IDENTIFIER)
+            {
+                Token bad = curr();
+                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                " - Expected identifier after const type";
+                string sug = "SUGGESTION: Provide variable name";
+                errors.push_back({errMsg, sug});
+                return;
+            }
+
+            if (t.type == TokenType::OP_PLUS)
+            {
+                // Unary + at statement level should only be allowed if numeric
+                Token opTok = curr();
+                advance();
+
+                if (curr().type == TokenType::TOK_IDENTIFIER)
+                {
+                    string id = curr().value;
+                    string idType = sym.getType(id);
+
+                    if (idType == "function" ||
+                        idType == "" ||
+                        idType == "string" ||
+                        idType == "char" ||
+                        idType == "void")
+                    {
+                        errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                                              " - Invalid use of unary '+' at statement level",
+                                          "SUGGESTION: Statements cannot start with unary '+' unless it's a numeric expression"});
+                        return;
+                    }
+                }
+
+                // If numeric, parse normally
+                parsePrimaryWithType();
+                expect(TokenType::SEMICOLON, ";");
+                return;
+            }
+
+            Token nameTok = curr();
+            string ident = nameTok.value;
+            advance();
+
+            parseVarDecl(type, ident, nameTok);
+            return;
+        }
+
+        // ============================================================================
+        // Handle struct declarations
+        // ============================================================================
+        // Inside parseStatement() in struct section
+        if (t.type == TokenType::KW_STRUCT)
+        {
+            parseStruct();
+            return;
+        }
+        if (t.type == TokenType::KW_ENUM)
+        {
+            parseEnum();
+            return;
+        }
+        // ============================================================================
+        // Handle regular type declarations (int, float, etc.)
+        // ============================================================================
+        if (isTypeToken(t))
+        {
+            string type = typeSpelling(t);
+            advance();
+
+            // Skip const if it's after type (shouldn't happen with our grammar)
+            if (curr().type == TokenType::KW_CONST)
+            {
+                type += " const";
+                advance();
+            }
+
+            // Handle pointers: int *p;
+            type += parsePointerStars();
+
+            if (!atDeclaratorName())
+            {
+                Token bad = curr();
+                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                                " - Expected identifier after type '" + type + "'";
+                string sug = "SUGGESTION: Provide variable or function name";
+                errors.push_back({errMsg, sug});
+                return;
+            }
+
+            Token nameTok = curr();
+            string ident = nameTok.value;
+            advance();
+
+            // Function or variable?
+            if (curr().type == TokenType::LPAREN)
+            {
+                parseFunction(type, ident, nameTok);
+            }
+            else
+            {
+                parseVarDecl(type, ident, nameTok);
+            }
+            return;
+        }
+        // ===============================================
+        // NEW: Reject invalid statement starters
+        // ===============================================
+        Token st = curr();
+
+        bool isValidStart =
+            st.type == TokenType::TOK_IDENTIFIER ||
+            st.type == TokenType::TOK_NUMBER ||
+            st.type == TokenType::TOK_STRING ||
+            st.type == TokenType::TOK_CHAR ||
+            st.type == TokenType::LPAREN ||
+            st.type == TokenType::OP_STAR ||
+            st.type == TokenType::KW_SIZEOF ||
+            st.type == TokenType::OP_MINUS ||
+            st.type == TokenType::OP_PLUS ||
+            st.type == TokenType::OP_NOT ||
+            st.type == TokenType::OP_BITNOT ||
+            st.type == TokenType::OP_INC ||
+            st.type == TokenType::OP_DEC;
+
+        if (!isValidStart)
+        {
+            string err =
+                "Line " + to_string(st.line) + ":" + to_string(st.column) +
+                " - Invalid statement start: '" + st.value + "'";
+            errors.push_back({err, "SUGGESTION: Statements must begin with an expression, literal, or identifier"});
+            advance();
+            return;
+        }
+
+        // Extra rule: / and % cannot start a statement
+        if (st.type == TokenType::OP_SLASH ||
+            st.type == TokenType::OP_PERCENT)
+        {
+            string err =
+                "Line " + to_string(st.line) + ":" + to_string(st.column) +
+                " - Invalid statement start: '" + st.value + "'";
+            errors.push_back({err, "SUGGESTION: Statements cannot begin with '" + st.value + "'"});
+            advance();
+            return;
+        }
+
+        // Unary op cannot apply to function name
+        if (st.type == TokenType::OP_MINUS ||
+            st.type == TokenType::OP_PLUS ||
+            st.type == TokenType::OP_NOT ||
+            st.type == TokenType::OP_BITNOT)
+        {
+            Token nxt = peek();
+            if (nxt.type == TokenType::TOK_IDENTIFIER &&
+                sym.getType(nxt.value) == "function")
+            {
+                string err =
+                    "Line " + to_string(st.line) + ":" + to_string(st.column) +
+                    " - Invalid unary operator '" + st.value + "' applied to function '" + nxt.value + "'";
+                errors.push_back({err, "SUGGESTION: Unary operators only apply to numeric expressions"});
+                advance();
+                return;
+            }
+        }
+
+        // Handle other statement types...
+        parseExprOrAssignment();
+        expect(TokenType::SEMICOLON, ";");
+    }
+
+    void parseExprOrAssignment()
+    {
+        Token t = curr();
+
+        // ============================================
+        // 1) COMPOUND ASSIGNMENTS (+= -= *= /= %=)
+        // MUST COME BEFORE NORMAL EXPRESSION PARSING
+        // ============================================
+        if (t.type == TokenType::TOK_IDENTIFIER &&
+            (peek().type == TokenType::OP_PLUSEQ ||
+             peek().type == TokenType::OP_MINUSEQ ||
+             peek().type == TokenType::OP_MULTEQ ||
+             peek().type == TokenType::OP_DIVEQ ||
+             peek().type == TokenType::OP_MODEQ))
+        {
+            Token idTok = curr();
+            string lhsType = sym.getType(idTok.value);
+
+            if constexpr (Policy::nameChecks)
+            {
+                if (!sym.exists(idTok.value))
+                {
+                    string err = "Line " + to_string(idTok.line) + ":" +
+                                 to_string(idTok.column) +
+                                 " - Undeclared variable '" + idTok.value + "'";
+                    errors.push_back({err, suggestionEngine.getSuggestion(err)});
+                }
+            }
+
+            advance(); // consume identifier
+            Token opTok = curr();
+            advance(); // consume the +=, -=, etc
+
+            flowEvent(FlowEvent::USE, idTok.value, idTok);
+            uint32_t rhsType = parseExpressionWithFullType();
+            flowEvent(FlowEvent::DEF, idTok.value, idTok);
+
+            if constexpr (Policy::typeChecks)
+            {
+                // TYPE CHECK
+                if (lhsType != "UNKNOWN" &&
+                    rhsType != unknownType &&
+                    !TypeSystem::areTypesCompatible(lhsType, typeName(rhsType)))
+                {
+                    string err =
+                        "Warning: Line " + to_string(opTok.line) + ":" +
+                        to_string(opTok.column) +
+                        " - Type mismatch in compound assignment '" + opTok.value + "'";
+                    errors.push_back({err, "SUGGESTION: Use matching arithmetic types"});
+                }
             }
 
             return; // handled
         }
 
-        // ============================================
-        // 2) SIMPLE ASSIGNMENT (=)
-        // ============================================
-        if (t.type == TokenType::TOK_IDENTIFIER &&
-            peek().type == TokenType::OP_ASSIGN)
+        // ============================================
+        // 2) SIMPLE ASSIGNMENT (=)
+        // ============================================
+        if (t.type == TokenType::TOK_IDENTIFIER &&
+            peek().type == TokenType::OP_ASSIGN)
+        {
+            Token idTok = curr();
+            string lhsType = sym.getType(idTok.value);
+
+            if constexpr (Policy::nameChecks)
+            {
+                if (!sym.exists(idTok.value))
+                {
+                    string err = "Line " + to_string(idTok.line) + ":" +
+                                 to_string(idTok.column) +
+                                 " - Undeclared variable '" + idTok.value + "'";
+                    errors.push_back({err, suggestionEngine.getSuggestion(err)});
+                }
+            }
+
+            advance(); // consume identifier
+            Token assignTok = curr();
+            advance(); // consume '='
+
+            uint32_t rhsType = parseExpressionWithFullType();
+            flowEvent(FlowEvent::DEF, idTok.value, idTok);
+
+            if constexpr (Policy::typeChecks)
+            {
+                if (lhsType != "UNKNOWN" &&
+                    rhsType != unknownType &&
+                    !TypeSystem::areTypesCompatible(lhsType, typeName(rhsType)))
+                {
+                    string err =
+                        "Warning: Line " + to_string(assignTok.line) + ":" +
+                        to_string(assignTok.column) +
+                        " - Type mismatch: assigning '" + typeName(rhsType) +
+                        "' to '" + lhsType + "'";
+                    errors.push_back({err, "SUGGESTION: Use compatible types"});
+                }
+            }
+
+            return;
+        }
+
+        // ============================================
+        // 3) FALLBACK → normal expression
+        // ============================================
+        parseExpression();
+    }
+
+    uint32_t parseExpression()
+    {
+        uint32_t type = parsePrimaryWithType();
+
+        while (isOp(curr()))
+        {
+            // ===============================
+            // INVALID OPERATOR SEQUENCE CHECK
+            // ===============================
+            bool extraAssign = (curr().type == TokenType::OP_EQ || curr().type == TokenType::OP_NE) &&
+                               peek().type == TokenType::OP_ASSIGN;
+            if (extraAssign ||
+                ((curr().type == TokenType::OP_EQ) &&
+                 (peek().type == TokenType::OP_LE || peek().type == TokenType::OP_GE || peek().type == TokenType::OP_LT || peek().type == TokenType::OP_GT)))
+            {
+                // This is the pattern: != =  (user typed !==)
+                Token bad = curr();
+                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                             " - Invalid operator sequence:  sequences like '!==' or '===' are not valid in C";
+                errors.push_back({err, "SUGGESTION: Use '!=' for inequality or '==' for equality"});
+
+                if (!extraAssign)
+                    advance(); // '==<': keep the relational operator
+            }
+
+            Token op = curr();
+            advance();
+            if (extraAssign)
+                advance(); // Skip the extra =
+            if (op.type == TokenType::OP_AND || op.type == TokenType::OP_OR)
+                countDecision();
+
+            // ERROR: Missing RHS operand
+            if (curr().type == TokenType::SEMICOLON ||
+                curr().type == TokenType::RPAREN ||
+                curr().type == TokenType::RBRACE ||
+                curr().type == TokenType::COMMA)
+            {
+                string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
+                                " - Incomplete expression: missing operand after '" + op.value + "'";
+                string sug = "SUGGESTION: Complete the expression. Example: x + y";
+                errors.push_back({errMsg, sug});
+                return type;
+            }
+
+            uint32_t rhsType = parsePrimaryWithType();
+
+            if constexpr (Policy::typeChecks)
+            {
+                // TYPE CHECKING
+                if (type != unknownType && rhsType != unknownType)
+                {
+                    string resultType = TypeSystem::getOperationResultType(typeName(type), typeName(rhsType), op.value);
+
+                    if (resultType == "INVALID")
+                    {
+                        string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
+                                        " - Type error: cannot apply '" + op.value + "' to '" + typeName(type) +
+                                        "' and '" + typeName(rhsType) + "'";
+                        string sug = "SUGGESTION: Ensure both operands are compatible types";
+                        errors.push_back({errMsg, sug});
+                    }
+                    else if (resultType != "UNKNOWN")
+                        type = typeId(resultType);
+                }
+            }
+        }
+        return type;
+    }
+
+    void parsePrimary()
+    {
+        Token t = curr();
+
+        if (t.type == TokenType::TOK_IDENTIFIER)
+        {
+            // CHECK 1: Is this identifier declared or a standard library function?
+            if constexpr (Policy::nameChecks)
+            {
+                if (!sym.exists(t.value))
+                {
+                    string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                                    " - Undeclared identifier '" + t.value + "'";
+                    string sug = suggestionEngine.getSuggestion(errMsg);
+                    errors.push_back({errMsg, sug});
+                }
+            }
+
+            advance();
+
+            // CHECK 2: If it's a function call, check all arguments
+            if (curr().type == TokenType::LPAREN)
+            {
+                advance(); // skip (
+
+                if (curr().type != TokenType::RPAREN)
+                {
+                    while (true)
+                    {
+                        // RECURSIVELY check arguments - will find undeclared vars in args
+                        parseExpression();
+
+                        if (curr().type == TokenType::COMMA)
+                        {
+                            advance();
+                        }
+                        else
+                        {
+                            break;
+                        }
+                    }
+                }
+                expect(TokenType::RPAREN, ")");
+            }
+        }
+        // CHECK 3: Number literal - report if it's a bare statement like "2;"
+        else if (t.type == TokenType::TOK_NUMBER)
+        {
+            // Numbers are OK in expressions, but bare "2;" is suspicious
+            // Let the caller decide if this is an error (bare statement)
+            advance();
+        }
+        // CHECK 4: String literal
+        else if (t.type == TokenType::TOK_STRING)
+        {
+            advance();
+        }
+        // CHECK 5: Character literal
+        else if (t.type == TokenType::TOK_CHAR)
+        {
+            advance();
+        }
+        // CHECK 6: Parenthesized expression
+        else if (t.type == TokenType::LPAREN)
+        {
+            advance();
+            parseExpression(); // RECURSIVE - will check nested identifiers
+            expect(TokenType::RPAREN, ")");
+        }
+        // CHECK 7: Unary operators
+        else if (t.type == TokenType::OP_MINUS || t.type == TokenType::OP_PLUS ||
+                 t.type == TokenType::OP_NOT || t.type == TokenType::OP_BITNOT)
+        {
+            advance();
+            parsePrimary(); // Check the operand
+        }
+        // CHECK 8: Increment/Decrement
+        else if (t.type == TokenType::OP_INC || t.type == TokenType::OP_DEC)
+        {
+            advance();
+            parsePrimary();
+        }
+        // ERROR: Unexpected token
+        else if (t.type != TokenType::SEMICOLON &&
+                 t.type != TokenType::RPAREN &&
+                 t.type != TokenType::RBRACE &&
+                 t.type != TokenType::COMMA &&
+                 t.type != TokenType::TOK_EOF)
+        {
+            string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                            " - Unexpected token '" + t.value + "'";
+            string sug = suggestionEngine.getSuggestion(errMsg);
+            errors.push_back({errMsg, sug});
+            advance();
+        }
+    }
+
+    // identifier '(' args ')': checks the call against the signature table and
+    // returns the callee's return type
+    uint32_t parseCallWithType(const Token &idTok, size_t idIndex, uint32_t nameId)
+    {
+        advance(); // consume '('
+
+        vector<uint32_t> argTypes;
+        vector<size_t> argStarts; // token index where each argument begins
+
+        // Parse arguments if any
+        if (curr().type != TokenType::RPAREN)
+        {
+            while (true)
+            {
+                argStarts.push_back(index);
+                argTypes.push_back(parseExpressionWithFullType());
+
+                if (curr().type == TokenType::COMMA)
+                    advance();
+                else
+                    break;
+            }
+        }
+
+        expect(TokenType::RPAREN, ")");
+        recordNode(NodeKind::Call, idIndex, idIndex, index, idTok.value, "", (int)argTypes.size());
+
+        // ------------------------------------
+        // ARGUMENT CHECK against the signature table
+        // ------------------------------------
+        if constexpr (Policy::callChecks)
+        {
+            const FunctionSignature *sig = findSignature(nameId);
+            if (!sig)
+                return intType; // implicit declaration: nothing to check against
+
+            checkCallArguments(idTok, *sig, argTypes);
+            if (sig->header >= 0)
+                checkHeaderIncluded(idTok, sig->header);
+
+            // printf/scanf family: the format is the last fixed parameter
+            size_t fmtArg = sig->paramTypes.size() - 1;
+            bool scanStyle = FormatStringParser::isScanfFamily(idTok.value);
+            if (sig->variadic && (scanStyle || FormatStringParser::isPrintfFamily(idTok.value)) &&
+                fmtArg < argStarts.size() && tokens[argStarts[fmtArg]].type == TokenType::TOK_STRING &&
+                (fmtArg + 1 < argStarts.size() ? argStarts[fmtArg + 1] : index) == argStarts[fmtArg] + 2)
+            {
+                checkFormatString(idTok, tokens[argStarts[fmtArg]], scanStyle, argTypes, fmtArg + 1);
+            }
+            return sig->returnType;
+        }
+        return unknownType;
+    }
+
+    // Index just past the ')' when tokens[i..] spells "type-name )", 0 otherwise.
+    // Memoized per position: the same '(' is probed as a cast, as a sizeof operand
+    // and again when error recovery re-parses a span
+    size_t typeNameEnd(size_t i)
+    {
+        if (i >= tokens.size())
+            return 0;
+        if (typeNameMemo.size() != tokens.size())
+            typeNameMemo.assign(tokens.size(), -1);
+        int32_t &memo = typeNameMemo[i];
+        if (memo >= 0)
+            return memo;
+
+        size_t j = i;
+        while (j < tokens.size() && tokens[j].type == TokenType::KW_CONST)
+            j++;
+        classifyThrough(j);
+        if (j >= tokens.size() || !isTypeToken(tokens[j]))
+            return memo = 0;
+        if (tokens[j].type == TokenType::KW_STRUCT || tokens[j].type == TokenType::KW_ENUM)
+        {
+            j++;
+            if (j >= tokens.size() || !isTagToken(tokens[j]))
+                return memo = 0;
+        }
+        j++;
+        while (j < tokens.size() && (tokens[j].type == TokenType::OP_STAR || tokens[j].type == TokenType::KW_CONST))
+            j++;
+        memo = (j < tokens.size() && tokens[j].type == TokenType::RPAREN) ? int32_t(j + 1) : 0;
+        return memo;
+    }
+
+    // type-name inside a cast or sizeof; typeNameEnd() has already checked its shape
+    string parseTypeName()
+    {
+        while (curr().type == TokenType::KW_CONST)
+            advance();
+
+        string type = typeSpelling(curr());
+        advance();
+        if (type == "struct" || type == "enum")
+        {
+            type = type == "enum" ? "int" : "struct " + curr().value;
+            advance();
+        }
+
+        while (curr().type == TokenType::OP_STAR || curr().type == TokenType::KW_CONST)
+        {
+            if (curr().type == TokenType::OP_STAR)
+                type += "*";
+            advance();
+        }
+        return type;
+    }
+
+    // Expands typedef names, keeping pointer/array suffixes: "Point*" -> "struct Point*"
+    string resolveType(const string &type) const
+    {
+        string t = type;
+        for (int depth = 0; depth < 8; depth++)
+        {
+            size_t cut = t.find_first_of("*[");
+            auto td = typedefs.find(t.substr(0, cut));
+            if (td == typedefs.end())
+                break;
+            t = td->second + (cut == string::npos ? "" : t.substr(cut));
+        }
+        return t;
+    }
+
+    string derefType(const string &type, const Token &star)
+    {
+        string t = resolveType(type);
+        if (t.empty() || t == "UNKNOWN" || t == "function")
+            return "UNKNOWN";
+        if (t.size() > 2 && t.compare(t.size() - 2, 2, "[]") == 0)
+            return t.substr(0, t.size() - 2);
+        if (TypeSystem::isPointer(t))
+            return TypeSystem::basePointerType(t);
+        if (TypeSystem::isString(t))
+            return "char";
+
+        if constexpr (Policy::typeChecks)
+        {
+            string err = "Line " + to_string(star.line) + ":" + to_string(star.column) +
+                         " - Invalid: cannot dereference non-pointer type '" + t + "'";
+            errors.push_back({err, "SUGGESTION: Only pointers can be dereferenced with '*'"});
+        }
+        return "UNKNOWN";
+    }
+
+    string subscriptType(const string &type, const string &indexType, const Token &bracket)
+    {
+        if constexpr (Policy::typeChecks)
+        {
+            if (indexType != "UNKNOWN" && !indexType.empty() &&
+                !TypeSystem::isInteger(indexType) && !TypeSystem::isChar(indexType))
+            {
+                string err = "Line " + to_string(bracket.line) + ":" + to_string(bracket.column) +
+                             " - Array subscript has type '" + indexType + "', expected an integer";
+                errors.push_back({err, "SUGGESTION: Index arrays with an integer expression"});
+            }
+        }
+
+        string t = resolveType(type);
+        if (t.empty() || t == "UNKNOWN")
+            return "UNKNOWN";
+        if (t.size() > 2 && t.compare(t.size() - 2, 2, "[]") == 0)
+            return t.substr(0, t.size() - 2);
+        if (TypeSystem::isPointer(t))
+            return TypeSystem::basePointerType(t);
+        if (TypeSystem::isString(t))
+            return "char";
+
+        if constexpr (Policy::typeChecks)
+        {
+            string err = "Line " + to_string(bracket.line) + ":" + to_string(bracket.column) +
+                         " - Subscripted value of type '" + t + "' is not an array or pointer";
+            errors.push_back({err, "SUGGESTION: Only arrays and pointers can be indexed with []"});
+        }
+        return "UNKNOWN";
+    }
+
+    string memberAccessType(const string &type, const Token &member, const Token &op)
+    {
+        string t = resolveType(type);
+        if (t.empty() || t == "UNKNOWN")
+            return "UNKNOWN";
+
+        bool arrow = op.type == TokenType::ARROW;
+        string base = arrow && TypeSystem::isPointer(t) ? resolveType(TypeSystem::basePointerType(t)) : t;
+        if (base.compare(0, 6, "const ") == 0) // members of a const struct are read like any other
+            base = base.substr(6);
+
+        if constexpr (Policy::typeChecks)
+        {
+            string at = "Line " + to_string(op.line) + ":" + to_string(op.column);
+            if (arrow && !TypeSystem::isPointer(t))
+            {
+                string sug = TypeSystem::isStruct(t) ? "SUGGESTION: Use '.' to access members of a struct value"
+                                                     : "SUGGESTION: '->' needs a pointer to a struct";
+                errors.push_back({at + " - Invalid: '->' applied to non-pointer type '" + t + "'", sug});
+                return "UNKNOWN";
+            }
+            if (!arrow && TypeSystem::isPointer(t))
+            {
+                errors.push_back({at + " - Invalid: '.' applied to pointer type '" + t + "'",
+                                  "SUGGESTION: Use '->' to access members through a pointer"});
+                return "UNKNOWN";
+            }
+            if (!TypeSystem::isStruct(base) || TypeSystem::isPointer(base))
+            {
+                errors.push_back({at + " - Invalid: member access on non-struct type '" + base + "'",
+                                  "SUGGESTION: '.' and '->' only apply to structs"});
+                return "UNKNOWN";
+            }
+        }
+
+        auto s = structMembers.find(base);
+        if (s == structMembers.end())
+            return "UNKNOWN"; // incomplete or unknown struct
+        auto m = s->second.find(member.value);
+        if (m == s->second.end())
+        {
+            if constexpr (Policy::typeChecks)
+            {
+                string err = "Line " + to_string(member.line) + ":" + to_string(member.column) +
+                             " - '" + base + "' has no member named '" + member.value + "'";
+                errors.push_back({err, "SUGGESTION: Check the member name against the struct definition"});
+            }
+            return "UNKNOWN";
+        }
+        return m->second;
+    }
+
+    // Postfix operators after a primary: [index], .member, ->member, (args), ++, --
+    uint32_t parsePostfixOps(uint32_t type)
+    {
+        while (true)
+        {
+            Token op = curr();
+            if (op.type == TokenType::LBRACKET)
+            {
+                advance();
+                uint32_t indexType = parseExpressionWithFullType();
+                expect(TokenType::RBRACKET, "]");
+                string element = subscriptType(typeName(type), typeName(indexType), op);
+                type = typeId(element);
+            }
+            else if (op.type == TokenType::DOT || op.type == TokenType::ARROW)
+            {
+                advance();
+                if (curr().type != TokenType::TOK_IDENTIFIER)
+                {
+                    string err = "Line " + to_string(op.line) + ":" + to_string(op.column) +
+                                 " - Expected member name after '" + op.value + "'";
+                    errors.push_back({err, "SUGGESTION: " + op.value + " must be followed by a struct member"});
+                    return unknownType;
+                }
+                Token member = curr();
+                advance();
+                string memberType = memberAccessType(typeName(type), member, op);
+                type = typeId(memberType);
+            }
+            else if (op.type == TokenType::LPAREN) // call through a pointer or member
+            {
+                advance();
+                if (curr().type != TokenType::RPAREN)
+                {
+                    while (true)
+                    {
+                        parseExpressionWithFullType();
+                        if (curr().type == TokenType::COMMA)
+                            advance();
+                        else
+                            break;
+                    }
+                }
+                expect(TokenType::RPAREN, ")");
+                type = unknownType;
+            }
+            else if (op.type == TokenType::OP_INC || op.type == TokenType::OP_DEC)
+            {
+                advance();
+            }
+            else
+            {
+                return type;
+            }
+        }
+    }
+
+    uint32_t parsePrimaryWithType()
+    {
+        Token t = curr();
+        bool underDeref = derefOperand; // only the operand directly after '*'
+        derefOperand = false;
+
+        // ===============================
+        // IDENTIFIER (variable or function)
+        // ===============================
+        if (t.type == TokenType::TOK_IDENTIFIER)
+        {
+            VarInfo *var = sym.lookup(t.value);
+            uint32_t type = var ? var->typeId : typeId(sym.getType(t.value));
+            if (var && var->fileScope)
+                summary.references.push_back(StringInterner::current().intern(t.value));
+            Token idTok = t;
+            size_t idIndex = index;
+
+            if constexpr (Policy::nameChecks)
+            {
+                if (!sym.exists(t.value))
+                {
+                    string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                                    " - Undeclared identifier '" + t.value + "'";
+                    errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
+                }
+            }
+
+            advance(); // consume identifier
+
+            // calls and address-taken uses alike keep a function reachable
+            bool isCall = curr().type == TokenType::LPAREN;
+            uint32_t nameId = isCall || type == functionType ? StringInterner::current().intern(idTok.value) : 0;
+            if (type == functionType)
+                summary.calls.push_back({metrics ? (int32_t)functionMetrics.size() : -1, nameId});
+
+            // reads of local variables feed the dataflow checks; "x = ..." inside an
+            // expression counts as an assignment, "*p = ..." does not assign p
+            if (curr().type == TokenType::OP_ASSIGN && !underDeref)
+                flowEvent(FlowEvent::DEF, idTok.value, idTok);
+            else if (!isCall)
+                flowEvent(FlowEvent::USE, idTok.value, idTok);
+
+            // ------------------------------------
+            // FUNCTION CALL: identifier '(' ... ')'
+            // ------------------------------------
+            if (isCall)
+                return parsePostfixOps(parseCallWithType(idTok, idIndex, nameId));
+
+            // ------------------------------------
+            // POSTFIX INC/DEC
+            // ------------------------------------
+            if (curr().type == TokenType::OP_INC || curr().type == TokenType::OP_DEC)
+            {
+                Token opTok = curr();
+
+                if constexpr (Policy::lvalueChecks)
+                {
+                    // Validate lvalue
+                    if (type == functionType || !isModifiableLvalue(idTok, typeName(type)))
+                    {
+                        string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                                        " - Invalid: cannot apply '" + opTok.value +
+                                        "' to '" + idTok.value + "' (not a modifiable lvalue)";
+                        errors.push_back({errMsg, "SUGGESTION: ++/-- require a modifiable variable"});
+                    }
+                }
+
+                flowEvent(FlowEvent::DEF, idTok.value, idTok);
+                advance();
+            }
+
+            return parsePostfixOps(type);
+        }
+
+        // ===============================
+        // NUMBER LITERAL
+        // ===============================
+        else if (t.type == TokenType::TOK_NUMBER)
+        {
+            advance();
+            return literalTypeId(t);
+        }
+
+        // ===============================
+        // STRING LITERAL
+        // ===============================
+        else if (t.type == TokenType::TOK_STRING)
+        {
+            advance();
+            return stringType;
+        }
+
+        // ===============================
+        // CHAR LITERAL
+        // ===============================
+        else if (t.type == TokenType::TOK_CHAR)
+        {
+            advance();
+            return charType;
+        }
+
+        // ===============================
+        // CAST: '(' type-name ')' operand
+        // ===============================
+        else if (t.type == TokenType::LPAREN && typeNameEnd(index + 1))
+        {
+            advance();
+            string castType = parseTypeName();
+            expect(TokenType::RPAREN, ")");
+
+            if (curr().type == TokenType::SEMICOLON || curr().type == TokenType::RPAREN ||
+                curr().type == TokenType::COMMA || curr().type == TokenType::RBRACE ||
+                curr().type == TokenType::TOK_EOF)
+            {
+                errors.push_back({"Line " + to_string(t.line) + ":" + to_string(t.column) +
+                                      " - Incomplete expression: missing operand after cast to '" + castType + "'",
+                                  "SUGGESTION: A cast applies to the expression that follows it, e.g. (int)x"});
+                return typeId(castType);
+            }
+            parsePrimaryWithType();
+            return typeId(castType);
+        }
+
+        // ===============================
+        // PARENTHESIZED EXPRESSION
+        // ===============================
+        else if (t.type == TokenType::LPAREN)
+        {
+            advance();
+            uint32_t type = parseExpressionWithType();
+            expect(TokenType::RPAREN, ")");
+            return parsePostfixOps(type);
+        }
+
+        // ===============================
+        // SIZEOF: sizeof(type-name) or sizeof expression
+        // ===============================
+        else if (t.type == TokenType::KW_SIZEOF)
+        {
+            advance();
+            if (curr().type == TokenType::LPAREN && typeNameEnd(index + 1))
+            {
+                advance();
+                parseTypeName();
+                expect(TokenType::RPAREN, ")");
+            }
+            else
+            {
+                unevaluated++; // the operand is never evaluated
+                parsePrimaryWithType();
+                unevaluated--;
+            }
+            return intType;
+        }
+
+        // ===============================
+        // DEREFERENCE (*p)
+        // ===============================
+        else if (t.type == TokenType::OP_STAR)
+        {
+            advance();
+            derefOperand = true;
+            uint32_t pointer = parsePrimaryWithType();
+            string pointee = derefType(typeName(pointer), t);
+            return typeId(pointee);
+        }
+
+        // ===============================
+        // PREFIX INC/DEC
+        // ===============================
+        else if (t.type == TokenType::OP_INC || t.type == TokenType::OP_DEC)
+        {
+            advance();
+            size_t operandStart = index;
+            uint32_t type = parsePrimaryWithType();
+
+            if (index == operandStart + 1 && tokens[operandStart].type == TokenType::TOK_IDENTIFIER)
+            {
+                const Token &idTok = tokens[operandStart];
+                if constexpr (Policy::lvalueChecks)
+                {
+                    if (type == functionType || !isModifiableLvalue(idTok, typeName(type)))
+                    {
+                        string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
+                                        " - Invalid: cannot apply '" + t.value +
+                                        "' to '" + idTok.value + "' (not a modifiable lvalue)";
+                        errors.push_back({errMsg, "SUGGESTION: ++/-- require a modifiable variable"});
+                    }
+                }
+                flowEvent(FlowEvent::DEF, idTok.value, idTok);
+            }
+            return type;
+        }
+
+        // ===============================
+        // ADDRESS-OF (&)
+        // ===============================
+        else if (t.type == TokenType::OP_BITAND)
+        {
+            Token opTok = curr();
+            advance();
+
+            if (curr().type != TokenType::TOK_IDENTIFIER)
+            {
+                string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                                " - Address-of operator & requires a variable";
+                errors.push_back({errMsg, "SUGGESTION: Use & with a variable. Example: &x"});
+                return unknownType;
+            }
+
+            Token idTok = curr();
+            string varType = sym.getType(idTok.value);
+
+            if constexpr (Policy::nameChecks)
+            {
+                if (!sym.exists(idTok.value))
+                {
+                    string errMsg = "Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
+                                    " - Undeclared variable '" + idTok.value + "'";
+                    errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
+                }
+            }
+
+            flowEvent(FlowEvent::ESCAPE, idTok.value, idTok);
+            advance();
+            uint32_t target = parsePostfixOps(typeId(varType)); // &a[i], &s.f, &p->f
+            return typeId(typeName(target) + "*");
+        }
+
+        // ===============================
+        // PREFIX UNARY OPS
+        // ===============================
+        else if (t.type == TokenType::OP_PLUS ||
+                 t.type == TokenType::OP_MINUS ||
+                 t.type == TokenType::OP_NOT ||
+                 t.type == TokenType::OP_BITNOT)
         {
-            Token idTok = curr();
-            string lhsType = sym.getType(idTok.value);
+            Token opTok = curr();
+            advance();
 
-            if (!sym.exists(idTok.value))
+            // Detect nonsense like +*- or -/ or !~+
+            if (curr().type == TokenType::OP_PLUS ||
+                curr().type == TokenType::OP_MINUS ||
+                curr().type == TokenType::OP_STAR ||
+                curr().type == TokenType::OP_SLASH ||
+                curr().type == TokenType::OP_PERCENT ||
+                curr().type == TokenType::OP_BITAND ||
+                curr().type == TokenType::OP_BITOR ||
+                curr().type == TokenType::OP_BITXOR)
             {
-                string err = "Line " + to_string(idTok.line) + ":" +
-                             to_string(idTok.column) +
-                             " - Undeclared variable '" + idTok.value + "'";
-                errors.push_back({err, suggestionEngine.getSuggestion(err)});
+                string err =
+                    "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                    " - Invalid operator sequence starting at '" + opTok.value + "'";
+                errors.push_back({err,
+                                  "SUGGESTION: Unary operators must be followed by a valid expression"});
+
+                advance(); // skip garbage
+                return unknownType;
             }
 
-            advance(); // consume identifier
-            Token assignTok = curr();
-            advance(); // consume '='
+            // ERROR: operand missing
+            if (curr().type == TokenType::SEMICOLON ||
+                curr().type == TokenType::RPAREN ||
+                curr().type == TokenType::RBRACE ||
+                curr().type == TokenType::COMMA)
+            {
+                errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                                      " - Incomplete unary expression after '" + opTok.value + "'",
+                                  "SUGGESTION: Provide a valid operand"});
+                return unknownType;
+            }
+
+            // ===================================================
+            // NEW: block unary +, -, !, ~ on FUNCTION identifiers
+            // ===================================================
+            if (curr().type == TokenType::TOK_IDENTIFIER)
+            {
+                string id = curr().value;
+                string idType = sym.getType(id);
+
+                if (idType == "function")
+                {
+                    errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                                          " - Unary operator '" + opTok.value +
+                                          "' cannot be applied to function '" + id + "'",
+                                      "SUGGESTION: Functions must be called normally, e.g. " + id + "();"});
+
+                    advance();
+                    return unknownType;
+                }
+            }
+
+            return parsePrimaryWithType();
+        }
+
+        // ===============================
+        // BAD BINARY OP AT START
+        // ===============================
+        else if (t.type == TokenType::OP_EQ || t.type == TokenType::OP_NE ||
+                 t.type == TokenType::OP_AND || t.type == TokenType::OP_OR)
+        {
+            Token opTok = curr();
+            string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
+                            " - Invalid: operator '" + opTok.value + "' cannot start an expression";
+            errors.push_back({errMsg, "SUGGESTION: Add a left operand"});
+            advance();
+            return unknownType;
+        }
+        // ==========================================================
+        // STEP 5: Detect two consecutive primaries without an operator
+        // ==========================================================
+        if (curr().type == TokenType::TOK_IDENTIFIER ||
+            curr().type == TokenType::TOK_NUMBER ||
+            curr().type == TokenType::TOK_STRING ||
+            curr().type == TokenType::TOK_CHAR)
+        {
+            Token bad = curr();
+            string err =
+                "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                " - Unexpected token '" + bad.value + "' after expression";
+            errors.push_back({err,
+                              "SUGGESTION: Missing operator between expressions"});
+
+            advance(); // Prevent infinite loop
+        }
+
+        // ===============================
+        // FALLBACK
+        // ===============================
+        return unknownType;
+    }
+
+    bool isModifiableLvalue(const Token &token, const string &symType)
+    {
+        // A modifiable lvalue for ++/-- must be:
+        // 1. An identifier (not a literal)
+        // 2. A VARIABLE type, not a function
+        // 3. NOT a standard library function
+        // 4. NOT a user-defined function (symType would be "function")
+        // 5. A complete object type (not incomplete/function type)
+
+        if (token.type != TokenType::TOK_IDENTIFIER)
+        {
+            return false; // Literals are not lvalues
+        }
+
+        // REJECT: User-defined functions
+        if (symType == "function")
+        {
+            return false; // Cannot apply ++/-- to functions
+        }
+
+        // REJECT: Standard library functions
+        if (stdLib.isStdioFunction(token.value) ||
+            stdLib.isStdlibFunction(token.value) ||
+            stdLib.isStringFunction(token.value) ||
+            stdLib.isMathFunction(token.value))
+        {
+            return false; // Standard library functions are not modifiable lvalues
+        }
+
+        // REJECT: Undeclared or unknown type
+        if (symType == "UNKNOWN" || symType == "" || (symType == "int" && !sym.exists(token.value)))
+        {
+            return false; // Not a declared variable
+        }
+
+        // ACCEPT: It's a declared variable with a concrete type
+        return true;
+    }
+
+    uint32_t parseExpressionWithFullType()
+    {
+        uint32_t lhs = parsePrimaryWithType();
+
+        while (isValidBinaryOp(curr().type))
+        {
+            // ===============================
+            // INVALID OPERATOR SEQUENCE CHECK
+            // ===============================
+            bool extraAssign = (curr().type == TokenType::OP_EQ || curr().type == TokenType::OP_NE) &&
+                               peek().type == TokenType::OP_ASSIGN;
+            if (extraAssign ||
+                ((curr().type == TokenType::OP_EQ) &&
+                 (peek().type == TokenType::OP_LE || peek().type == TokenType::OP_GE || peek().type == TokenType::OP_LT || peek().type == TokenType::OP_GT)))
+            {
+                // This is the pattern: != =  (user typed !==)
+                Token bad = curr();
+                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
+                             " - Invalid operator sequence:  sequences like '!==' or '===' are not valid in C";
+                errors.push_back({err, "SUGGESTION: Use '!=' for inequality or '==' for equality"});
+
+                if (!extraAssign)
+                    advance(); // '==<': keep the relational operator
+            }
+
+            Token op = curr();
+            advance();
+            if (extraAssign)
+                advance(); // Skip the extra =
+            if (op.type == TokenType::OP_AND || op.type == TokenType::OP_OR)
+                countDecision();
+
+            uint32_t rhs = parsePrimaryWithType();
+
+            if constexpr (Policy::typeChecks)
+            {
+                // If any side is UNKNOWN → carry on but do not error
+                if (lhs != unknownType && rhs != unknownType)
+                {
+                    string result = TypeSystem::getOperationResultType(typeName(lhs), typeName(rhs), op.value);
+
+                    if (result == "INVALID")
+                    {
+                        string err =
+                            "Line " + to_string(op.line) + ":" + to_string(op.column) +
+                            " - Type mismatch: cannot apply operator '" + op.value +
+                            "' between '" + typeName(lhs) + "' and '" + typeName(rhs) + "'";
+                        errors.push_back({err,
+                                          "SUGGESTION: Convert operands or use compatible types."});
+                    }
+                    else
+                    {
+                        lhs = typeId(result);
+                    }
+                }
+            }
+        }
+
+        // cond ? a : b
+        if (curr().type == TokenType::QUESTION)
+        {
+            advance();
+            countDecision();
+            uint32_t whenTrue = parseExpressionWithFullType();
+            expect(TokenType::COLON, ":");
+            uint32_t whenFalse = parseExpressionWithFullType();
+            lhs = whenTrue != unknownType ? whenTrue : whenFalse;
+        }
+
+        return lhs;
+    }
+
+    void endPrelude()
+    {
+        errors.clear();
+        functionMetrics.clear();
+        ruleNodes.clear();
+        summary = UnitSummary();
+        definedLayouts.clear();
+    }
+
+    // Top-level declarations up to token 'end', which reads as EOF
+    void parseUnit(size_t end)
+    {
+        unitEnd = end;
+        size_t maxIter = end - index + 1; // every iteration consumes at least one token
+        size_t iter = 0;
+        while (curr().type != TokenType::TOK_EOF && iter++ < maxIter)
+        {
+            lastIndex = index;
+            if (curr().type == TokenType::PREPROCESSOR)
+            {
+                parsePreprocessor();
+                continue;
+            }
+            correctKeywordTypo();
+            if (curr().type == TokenType::KW_TYPEDEF)
+            {
+                parseTypedef();
+                forceAdvance();
+                continue;
+            }
+            if (curr().type == TokenType::KW_STRUCT)
+            {
+                parseStruct();
+                forceAdvance();
+                continue;
+            }
+            if (curr().type == TokenType::KW_ENUM)
+            {
+                parseEnum();
+                forceAdvance();
+                continue;
+            }
+            else if (isTypeToken(curr()) || isStorageClass(curr()))
+                parseDeclOrFunc();
+            else if (curr().type == TokenType::TOK_ERROR)
+                advance();
+            else
+            {
+                Token bad = curr();
+                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Unexpected at file scope";
+                string sug = suggestionEngine.getSuggestion(errMsg);
+                errors.push_back({errMsg, sug});
+                advance();
+            }
+            forceAdvance();
+        }
+        if (iter >= maxIter)
+            errors.push_back({"Parser stuck - aborting", ""});
+        index = lastIndex = end;
+    }
+
+public:
+    // The tokens before headerEnds.back() are header code: parsed for what it
+    // declares, its own diagnostics are dropped
+    ParserT(const vector<Token> &toks, vector<size_t> headers = {})
+        : tokens(toks), index(0), lastIndex(0), headerEnds(move(headers)), unitEnd(tokens.size()) {}
+
+    void parseProgram()
+    {
+        // one header at a time: a header cut off mid-declaration ('int f(')
+        // must not swallow the next header or the file
+        for (size_t end : headerEnds)
+            parseUnit(end);
+        if (!headerEnds.empty())
+            endPrelude();
+        parseUnit(tokens.size());
+    }
+
+    vector<pair<string, string>> getErrorsWithSuggestions() const { return errors; }
+    vector<FunctionMetrics> getFunctionMetrics() const { return functionMetrics; }
+    const vector<RuleNode> &getRuleNodes() const { return ruleNodes; }
+    UnitSummary &getSummary() { return summary; }
+    const vector<StructLayout> &getStructLayouts() const { return definedLayouts; }
+    void setTarget(TargetABI target) { abi = &ABILayout::of(target); }
+    const vector<Token> &getTokens() const { return tokens; } // with misspelled keywords corrected
+};
 
-            string rhsType = parseExpressionWithFullType();
+using Parser = ParserT<FullChecks>;
 
-            if (lhsType != "UNKNOWN" &&
-                rhsType != "UNKNOWN" &&
-                !TypeSystem::areTypesCompatible(lhsType, rhsType))
-            {
-                string err =
-                    "Warning: Line " + to_string(assignTok.line) + ":" +
-                    to_string(assignTok.column) +
-                    " - Type mismatch: assigning '" + rhsType +
-                    "' to '" + lhsType + "'";
-                errors.push_back({err, "SUGGESTION: Use compatible types"});
-            }
+// ============================================================================
+// CLONE DETECTION MODULE (Rabin-Karp over normalized token kinds)
+// ============================================================================
 
-            return;
-        }
+// A pair of token regions with identical kind sequences. 'first' is the
+// earlier occurrence in batch order, 'second' the copy found later.
+struct CloneRegion
+{
+    uint32_t file;
+    uint32_t offset; // index into the file's compact stream
+    int line, column, endLine;
+};
 
-        // ============================================
-        // 3) FALLBACK → normal expression
-        // ============================================
-        parseExpression();
-    }
+struct ClonePair
+{
+    CloneRegion first, second;
+    uint32_t tokenCount;
+};
 
-    string parseExpression()
+class CloneDetector
+{
+private:
+    // Compact token stream: only the kind survives, so identifiers,
+    // literals and keywords of a given kind all compare equal
+    struct KindStream
     {
-        string type = parsePrimaryWithType();
+        vector<uint8_t> kinds;
+        vector<int> lines, columns;
+    };
 
-        while (isOp(curr()))
-        {
-            // ===============================
-            // INVALID OPERATOR SEQUENCE CHECK
-            // ===============================
-            if (((curr().type == TokenType::OP_NOT || curr().type == TokenType::OP_ASSIGN || peek().type == TokenType::OP_EQ) &&
-                 (curr().type == TokenType::OP_ASSIGN || peek().type == TokenType::OP_EQ)) ||
-                ((curr().type == TokenType::OP_EQ) &&
-                 (peek().type == TokenType::OP_LE || peek().type == TokenType::OP_GE || peek().type == TokenType::OP_LT || peek().type == TokenType::OP_GT)))
-            {
-                // This is the pattern: ! = =  (user typed !==)
-                Token bad = curr();
-                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                             " - Invalid operator sequence:  sequences like '!==' or '===' are not valid in C";
-                errors.push_back({err, "SUGGESTION: Use '!=' for inequality or '==' for equality"});
+    static const uint64_t BASE = 1000003ULL; // hashes wrap mod 2^64
 
-                // Skip the extra =
-                advance();
-            }
+    size_t minTokens;
+    vector<KindStream> streams;
 
-            Token op = curr();
-            advance();
+    static uint64_t occurrence(uint32_t file, uint32_t offset) { return ((uint64_t)file << 32) | offset; }
 
-            // ERROR: Missing RHS operand
-            if (curr().type == TokenType::SEMICOLON ||
-                curr().type == TokenType::RPAREN ||
-                curr().type == TokenType::RBRACE ||
-                curr().type == TokenType::COMMA)
+    static bool endsStatement(uint8_t kind)
+    {
+        return kind == (uint8_t)TokenType::SEMICOLON || kind == (uint8_t)TokenType::RBRACE;
+    }
+
+    // Long initializer lists ({1, 2, 3, ...}) or runs of 'a[0] = 0;' are
+    // not worth reporting; require several statements and some variety
+    static bool isInteresting(const uint8_t *kinds, size_t n)
+    {
+        uint64_t seen[4] = {0, 0, 0, 0};
+        int distinct = 0, statements = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t bit = 1ULL << (kinds[i] & 63);
+            if (!(seen[kinds[i] >> 6] & bit))
             {
-                string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
-                                " - Incomplete expression: missing operand after '" + op.value + "'";
-                string sug = "SUGGESTION: Complete the expression. Example: x + y";
-                errors.push_back({errMsg, sug});
-                return type;
+                seen[kinds[i] >> 6] |= bit;
+                distinct++;
             }
+            if (endsStatement(kinds[i]) || kinds[i] == (uint8_t)TokenType::LBRACE)
+                statements++;
+        }
+        return distinct >= 8 && statements >= 3;
+    }
 
-            string rhsType = parsePrimaryWithType();
+    CloneRegion region(uint32_t file, uint32_t offset, uint32_t count) const
+    {
+        const KindStream &s = streams[file];
+        return {file, offset, s.lines[offset], s.columns[offset], s.lines[offset + count - 1]};
+    }
 
-            // TYPE CHECKING
-            if (type != "UNKNOWN" && rhsType != "UNKNOWN")
-            {
-                string resultType = TypeSystem::getOperationResultType(type, rhsType, op.value);
+public:
+    CloneDetector(size_t minimumTokens = 50) : minTokens(minimumTokens) {}
 
-                if (resultType == "INVALID")
-                {
-                    string errMsg = "Line " + to_string(op.line) + ":" + to_string(op.column) +
-                                    " - Type error: cannot apply '" + op.value + "' to '" + type +
-                                    "' and '" + rhsType + "'";
-                    string sug = "SUGGESTION: Ensure both operands are compatible types";
-                    errors.push_back({errMsg, sug});
-                }
-                type = (resultType == "INVALID" || resultType == "UNKNOWN") ? type : resultType;
-            }
+    // Files are numbered in the order they are added
+    void addFile(const vector<Token> &tokens)
+    {
+        KindStream s;
+        s.kinds.reserve(tokens.size());
+        s.lines.reserve(tokens.size());
+        s.columns.reserve(tokens.size());
+        for (const Token &t : tokens)
+        {
+            if (t.type == TokenType::TOK_EOF || t.type == TokenType::PREPROCESSOR)
+                continue;
+            s.kinds.push_back((uint8_t)t.type);
+            s.lines.push_back(t.line);
+            s.columns.push_back(t.column);
         }
-        return type;
+        streams.push_back(move(s));
     }
 
-    void parsePrimary()
+    vector<ClonePair> findClones() const
     {
-        Token t = curr();
+        vector<ClonePair> clones;
+        if (minTokens == 0)
+            return clones;
 
-        if (t.type == TokenType::TOK_IDENTIFIER)
+        size_t total = 0;
+        for (const KindStream &s : streams)
+            total += s.kinds.size();
+
+        uint64_t topPower = 1; // BASE^(minTokens-1), to roll the oldest kind out
+        for (size_t i = 1; i < minTokens; i++)
+            topPower *= BASE;
+
+        // First occurrence of every window hash across the whole batch
+        unordered_map<uint64_t, uint64_t> firstSeen;
+        firstSeen.reserve(total);
+        vector<uint64_t> hashes;
+
+        for (uint32_t f = 0; f < streams.size(); f++)
         {
-            // CHECK 1: Is this identifier declared or a standard library function?
-            if (!sym.exists(t.value))
+            const vector<uint8_t> &kinds = streams[f].kinds;
+            if (kinds.size() < minTokens)
+                continue;
+
+            size_t windows = kinds.size() - minTokens + 1;
+            hashes.resize(windows);
+            uint64_t h = 0;
+            for (size_t i = 0; i < minTokens; i++)
+                h = h * BASE + kinds[i] + 1;
+            hashes[0] = h;
+            for (size_t i = 1; i < windows; i++)
             {
-                string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
-                                " - Undeclared identifier '" + t.value + "'";
-                string sug = suggestionEngine.getSuggestion(errMsg);
-                errors.push_back({errMsg, sug});
+                h = (h - (kinds[i - 1] + 1) * topPower) * BASE + kinds[i + minTokens - 1] + 1;
+                hashes[i] = h;
             }
 
-            advance();
-
-            // CHECK 2: If it's a function call, check all arguments
-            if (curr().type == TokenType::LPAREN)
+            size_t p = 0;
+            while (p < windows)
             {
-                advance(); // skip (
-
-                if (curr().type != TokenType::RPAREN)
+                auto ins = firstSeen.emplace(hashes[p], occurrence(f, (uint32_t)p));
+                if (ins.second)
                 {
-                    while (true)
-                    {
-                        // RECURSIVELY check arguments - will find undeclared vars in args
-                        parseExpression();
+                    p++;
+                    continue;
+                }
 
-                        if (curr().type == TokenType::COMMA)
-                        {
-                            advance();
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
+                uint32_t qf = (uint32_t)(ins.first->second >> 32);
+                uint32_t q = (uint32_t)ins.first->second;
+                const vector<uint8_t> &other = streams[qf].kinds;
+
+                // Same-file matches must not overlap the original
+                size_t limit = qf == f ? p - q : SIZE_MAX;
+                if (limit < minTokens || memcmp(&other[q], &kinds[p], minTokens) != 0 ||
+                    !isInteresting(&kinds[p], minTokens))
+                {
+                    p++;
+                    continue;
                 }
-                expect(TokenType::RPAREN, ")");
+
+                size_t len = minTokens;
+                while (p + len < kinds.size() && q + len < other.size() && len < limit &&
+                       other[q + len] == kinds[p + len])
+                    len++;
+                // End on a statement boundary so the next match starts cleanly
+                while (len > minTokens && !endsStatement(kinds[p + len - 1]))
+                    len--;
+
+                clones.push_back({region(qf, q, (uint32_t)len), region(f, (uint32_t)p, (uint32_t)len), (uint32_t)len});
+                p += len;
             }
         }
-        // CHECK 3: Number literal - report if it's a bare statement like "2;"
-        else if (t.type == TokenType::TOK_NUMBER)
-        {
-            // Numbers are OK in expressions, but bare "2;" is suspicious
-            // Let the caller decide if this is an error (bare statement)
-            advance();
-        }
-        // CHECK 4: String literal
-        else if (t.type == TokenType::TOK_STRING)
+        return clones;
+    }
+};
+
+// ============================================================================
+// CALL GRAPH MODULE (project-wide, iterative Tarjan SCC)
+// ============================================================================
+
+// Map: each file hands in its definitions and call edges. Reduce: callee
+// names are resolved to definitions once, edges sorted into a CSR adjacency
+// and the strongly connected components found without recursion, so a deep
+// call chain cannot overflow the stack. A static function is its own node,
+// and calls from its file reach it before any external function of that name.
+class CallGraph
+{
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Definition
+    {
+        uint32_t name;
+        uint32_t file;
+        int line;
+    };
+    vector<Definition> nodes;                 // first external definition of each name, every static one
+    unordered_map<uint32_t, uint32_t> nodeOf; // interned name -> node of its external definition
+    vector<vector<uint32_t>> fileNodes;       // per file: node of each function metric
+    vector<pair<uint32_t, uint32_t>> pending; // (caller node or NONE, callee name)
+    vector<pair<uint32_t, uint32_t>> edges;   // (caller, callee) nodes resolved so far
+
+    vector<uint32_t> offsets, targets; // CSR adjacency, distinct edges
+    vector<int> fanIn;
+    vector<uint32_t> roots; // main, and functions referenced at file scope
+
+public:
+    void addFile(const vector<FunctionMetrics> &defs, const vector<CallEdge> &calls,
+                 const vector<uint32_t> &staticDefs)
+    {
+        StringInterner &ids = StringInterner::current();
+        uint32_t file = (uint32_t)fileNodes.size();
+        vector<uint32_t> &local = fileNodes.emplace_back();
+        vector<char> isStatic(defs.size(), 0);
+        for (uint32_t d : staticDefs)
+            isStatic[d] = 1;
+
+        unordered_map<uint32_t, uint32_t> statics; // this file's static functions by name
+        for (size_t d = 0; d < defs.size(); d++)
         {
-            advance();
+            uint32_t name = ids.intern(defs[d].name);
+            auto [it, added] = (isStatic[d] ? statics : nodeOf).emplace(name, (uint32_t)nodes.size());
+            if (added)
+                nodes.push_back({name, file, defs[d].line});
+            local.push_back(it->second);
         }
-        // CHECK 5: Character literal
-        else if (t.type == TokenType::TOK_CHAR)
+        for (const CallEdge &e : calls)
         {
-            advance();
+            uint32_t caller = e.caller < 0 ? NONE : local[e.caller];
+            auto it = statics.find(e.callee);
+            if (it == statics.end())
+                pending.push_back({caller, e.callee});
+            else if (caller == NONE)
+                roots.push_back(it->second);
+            else
+                edges.push_back({caller, it->second});
         }
-        // CHECK 6: Parenthesized expression
-        else if (t.type == TokenType::LPAREN)
+    }
+
+    void build()
+    {
+        edges.reserve(edges.size() + pending.size());
+        for (const auto &[caller, callee] : pending)
         {
-            advance();
-            parseExpression(); // RECURSIVE - will check nested identifiers
-            expect(TokenType::RPAREN, ")");
+            auto it = nodeOf.find(callee);
+            if (it == nodeOf.end())
+                continue; // library or external function
+            if (caller == NONE)
+                roots.push_back(it->second);
+            else
+                edges.push_back({caller, it->second});
         }
-        // CHECK 7: Unary operators
-        else if (t.type == TokenType::OP_MINUS || t.type == TokenType::OP_PLUS ||
-                 t.type == TokenType::OP_NOT || t.type == TokenType::OP_BITNOT)
+        pending = {};
+        auto mainIt = nodeOf.find(StringInterner::current().intern("main"));
+        if (mainIt != nodeOf.end())
+            roots.push_back(mainIt->second);
+        else
+            roots.clear(); // a library: every function is an entry point
+
+        sort(edges.begin(), edges.end());
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+        offsets.assign(nodes.size() + 1, 0);
+        targets.resize(edges.size());
+        fanIn.assign(nodes.size(), 0);
+        for (const auto &[from, to] : edges)
         {
-            advance();
-            parsePrimary(); // Check the operand
+            offsets[from + 1]++;
+            if (from != to)
+                fanIn[to]++;
         }
-        // CHECK 8: Increment/Decrement
-        else if (t.type == TokenType::OP_INC || t.type == TokenType::OP_DEC)
+        for (size_t v = 0; v < nodes.size(); v++)
+            offsets[v + 1] += offsets[v];
+        for (size_t e = 0; e < edges.size(); e++)
+            targets[e] = edges[e].second; // edges are sorted by caller
+        edges = {};
+    }
+
+    int fanInOf(uint32_t node) const { return fanIn[node]; }
+    int fanOutOf(uint32_t node) const
+    {
+        int n = 0;
+        for (uint32_t e = offsets[node]; e < offsets[node + 1]; e++)
+            n += targets[e] != node;
+        return n;
+    }
+    uint32_t nodeOfMetric(size_t file, size_t metric) const { return fileNodes[file][metric]; }
+
+    // Components with more than one function, or a function calling itself
+    vector<vector<uint32_t>> recursiveComponents() const
+    {
+        size_t n = nodes.size();
+        vector<uint32_t> order(n, NONE), low(n);
+        vector<char> onStack(n, 0);
+        vector<uint32_t> stack;
+        vector<pair<uint32_t, uint32_t>> work; // (node, next edge) per active frame
+        vector<vector<uint32_t>> components;
+        uint32_t counter = 0;
+
+        for (uint32_t start = 0; start < n; start++)
         {
-            advance();
-            parsePrimary();
+            if (order[start] != NONE)
+                continue;
+            order[start] = low[start] = counter++;
+            stack.push_back(start);
+            onStack[start] = 1;
+            work.push_back({start, offsets[start]});
+
+            while (!work.empty())
+            {
+                uint32_t v = work.back().first;
+                uint32_t e = work.back().second;
+                if (e < offsets[v + 1])
+                {
+                    work.back().second++;
+                    uint32_t w = targets[e];
+                    if (order[w] == NONE)
+                    {
+                        order[w] = low[w] = counter++;
+                        stack.push_back(w);
+                        onStack[w] = 1;
+                        work.push_back({w, offsets[w]});
+                    }
+                    else if (onStack[w])
+                        low[v] = min(low[v], order[w]);
+                    continue;
+                }
+
+                work.pop_back();
+                if (!work.empty())
+                    low[work.back().first] = min(low[work.back().first], low[v]);
+                if (low[v] != order[v])
+                    continue;
+
+                vector<uint32_t> component;
+                uint32_t w;
+                do
+                {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = 0;
+                    component.push_back(w);
+                } while (w != v);
+
+                bool selfCall = binary_search(targets.begin() + offsets[v], targets.begin() + offsets[v + 1], v);
+                if (component.size() > 1 || selfCall)
+                    components.push_back(move(component));
+            }
         }
-        // ERROR: Unexpected token
-        else if (t.type != TokenType::SEMICOLON &&
-                 t.type != TokenType::RPAREN &&
-                 t.type != TokenType::RBRACE &&
-                 t.type != TokenType::COMMA &&
-                 t.type != TokenType::TOK_EOF)
+        return components;
+    }
+
+    // Functions no path from a root reaches; empty when there is no main
+    vector<uint32_t> unreachable() const
+    {
+        vector<uint32_t> result;
+        if (roots.empty())
+            return result;
+        vector<char> seen(nodes.size(), 0);
+        vector<uint32_t> queue;
+        for (uint32_t r : roots)
+            if (!seen[r])
+                seen[r] = 1, queue.push_back(r);
+        for (size_t q = 0; q < queue.size(); q++)
+            for (uint32_t e = offsets[queue[q]]; e < offsets[queue[q] + 1]; e++)
+                if (!seen[targets[e]])
+                    seen[targets[e]] = 1, queue.push_back(targets[e]);
+        for (uint32_t v = 0; v < nodes.size(); v++)
+            if (!seen[v])
+                result.push_back(v);
+        return result;
+    }
+
+    SymbolRef describe(uint32_t node, const vector<string> &files) const
+    {
+        const Definition &d = nodes[node];
+        return {StringInterner::current().name(d.name), files[d.file], d.line};
+    }
+};
+
+// ============================================================================
+// WORKSPACE INDEX MODULE (project-wide definitions and references)
+// ============================================================================
+
+// Per file: the external definitions it makes and the file-scope names it
+// refers to, as sorted interned-ID arrays. How many files refer to a name
+// is kept in an array indexed by its ID, so re-indexing an edited file
+// costs that file only and the report is one pass over the definitions.
+class WorkspaceIndex
+{
+private:
+    struct FileEntry
+    {
+        vector<pair<uint32_t, int>> definitions; // (name, line), sorted
+        vector<uint32_t> references;             // sorted, distinct
+    };
+    unordered_map<string, FileEntry> files; // by path
+    vector<uint32_t> referringFiles;        // interned name -> files referring to it
+
+    void count(const vector<uint32_t> &references, int delta)
+    {
+        for (uint32_t id : references)
         {
-            string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
-                            " - Unexpected token '" + t.value + "'";
-            string sug = suggestionEngine.getSuggestion(errMsg);
-            errors.push_back({errMsg, sug});
-            advance();
+            if (id >= referringFiles.size())
+                referringFiles.resize(id + 1, 0);
+            referringFiles[id] += delta;
         }
     }
 
-    string parsePrimaryWithType()
+public:
+    // Replaces what the index knew about the file
+    void update(const string &path, const UnitSummary &unit, const vector<FunctionMetrics> &metrics)
     {
-        Token t = curr();
+        StringInterner &ids = StringInterner::current();
+        FileEntry entry;
+        for (const ExternalSymbol &e : unit.externals)
+            if (e.definition)
+                entry.definitions.push_back({e.name, e.line});
+        sort(entry.definitions.begin(), entry.definitions.end());
+        entry.definitions.erase(unique(entry.definitions.begin(), entry.definitions.end(),
+                                       [](const auto &a, const auto &b)
+                                       { return a.first == b.first; }),
+                                entry.definitions.end());
+
+        entry.references = unit.references;
+        for (const CallEdge &c : unit.calls)
+            if (c.caller < 0 || metrics[c.caller].name != ids.name(c.callee)) // recursion is no use
+                entry.references.push_back(c.callee);
+
+        // the file's own static util is not another file's external util
+        vector<uint32_t> internal = unit.staticObjects;
+        for (uint32_t f : unit.staticFunctions)
+            internal.push_back(ids.intern(metrics[f].name));
+        sort(internal.begin(), internal.end());
+        entry.references.erase(remove_if(entry.references.begin(), entry.references.end(),
+                                         [&](uint32_t id)
+                                         { return binary_search(internal.begin(), internal.end(), id); }),
+                               entry.references.end());
+        sort(entry.references.begin(), entry.references.end());
+        entry.references.erase(unique(entry.references.begin(), entry.references.end()), entry.references.end());
+
+        remove(path);
+        count(entry.references, 1);
+        files[path] = move(entry);
+    }
 
-        // ===============================
-        // IDENTIFIER (variable or function)
-        // ===============================
-        if (t.type == TokenType::TOK_IDENTIFIER)
-        {
-            string type = sym.getType(t.value);
-            Token idTok = t;
+    void remove(const string &path)
+    {
+        auto it = files.find(path);
+        if (it == files.end())
+            return;
+        count(it->second.references, -1);
+        files.erase(it);
+    }
 
-            if (!sym.exists(t.value))
-            {
-                string errMsg = "Line " + to_string(t.line) + ":" + to_string(t.column) +
-                                " - Undeclared identifier '" + t.value + "'";
-                errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
-            }
+    size_t fileCount() const { return files.size(); }
 
-            advance(); // consume identifier
+    // Non-static functions and globals no indexed file refers to; main is an entry point
+    vector<SymbolRef> unused() const
+    {
+        StringInterner &ids = StringInterner::current();
+        uint32_t mainId = ids.intern("main");
+        vector<SymbolRef> result;
+        for (const auto &[path, entry] : files)
+            for (const auto &[name, line] : entry.definitions)
+                if (name != mainId && (name >= referringFiles.size() || referringFiles[name] == 0))
+                    result.push_back({ids.name(name), path, line});
+        sort(result.begin(), result.end(), [](const SymbolRef &a, const SymbolRef &b)
+             { return tie(a.file, a.line) < tie(b.file, b.line); });
+        return result;
+    }
+};
 
-            // ------------------------------------
-            // FUNCTION CALL: identifier '(' ... ')'
-            // ------------------------------------
-            if (curr().type == TokenType::LPAREN)
-            {
-                advance(); // consume '('
+// ============================================================================
+// FILE MAPPING MODULE (MappedFile lives in mapped_file.cpp)
+// ============================================================================
 
-                vector<string> argTypes;
+// A source file as the lexer wants it: UTF-8 without a byte order mark.
+// UTF-8 files are lexed straight from the mapping; others are transcoded.
+class SourceFile
+{
+private:
+    MappedFile map;
+    string transcoded;
+    string_view content;
+    SourceEncoding detected = SourceEncoding::UTF8;
 
-                // Parse arguments if any
-                if (curr().type != TokenType::RPAREN)
-                {
-                    while (true)
-                    {
-                        argTypes.push_back(parseExpressionWithFullType());
+public:
+    // false when the file cannot be read; a binary file opens but has no text
+    bool open(const string &path)
+    {
+        if (!map.open(path))
+            return false;
+        decodeSource(string_view(map.data(), map.size()), transcoded, content, detected);
+        return true;
+    }
 
-                        if (curr().type == TokenType::COMMA)
-                            advance();
-                        else
-                            break;
-                    }
-                }
+    bool isBinary() const { return detected == SourceEncoding::Binary; }
+    SourceEncoding encoding() const { return detected; }
+    string_view text() const { return content; }
+};
+
+// ============================================================================
+// INCLUDE MODULE (quoted #include resolution, multiple-include optimization)
+// ============================================================================
+
+// "#  ifndef X" -> "ifndef", with rest = "X"
+static string_view directiveName(string_view line, string_view &rest)
+{
+    rest = string_view();
+    size_t p = line.find_first_not_of(" \t", 1);
+    if (p == string_view::npos)
+        return string_view();
+    size_t e = p;
+    while (e < line.size() && (isalnum((unsigned char)line[e]) || line[e] == '_'))
+        e++;
+    size_t r = line.find_first_not_of(" \t", e);
+    if (r != string_view::npos)
+        rest = line.substr(r);
+    return line.substr(p, e - p);
+}
+
+static string_view leadingIdentifier(string_view s)
+{
+    size_t e = 0;
+    while (e < s.size() && (isalnum((unsigned char)s[e]) || s[e] == '_'))
+        e++;
+    return s.substr(0, e);
+}
+
+// What makes a header safe to skip when it is included again, found on its
+// first lex the way GCC's multiple-include optimization does: the whole file
+// sits inside #ifndef X / #define X ... #endif, or it says #pragma once
+struct IncludeGuard
+{
+    string macro; // controlling macro, empty when the file is not guarded
+    bool pragmaOnce = false;
+
+    // "#ifndef X" or "#if !defined(X)" -> X
+    static string_view guardCondition(string_view word, string_view rest)
+    {
+        if (word == "ifndef")
+            return leadingIdentifier(rest);
+        if (word != "if" || rest.empty() || rest[0] != '!')
+            return string_view();
+        rest = rest.substr(min(rest.find_first_not_of(" \t", 1), rest.size()));
+        if (leadingIdentifier(rest) != "defined")
+            return string_view();
+        rest = rest.substr(min(rest.find_first_not_of(" \t(", 7), rest.size()));
+        return leadingIdentifier(rest);
+    }
+
+    static IncludeGuard detect(const vector<Token> &tokens)
+    {
+        IncludeGuard guard;
+        size_t n = tokens.size();
+        string_view candidate;
+        size_t close = 0; // #endif of the first conditional
+        int depth = 0;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            if (tokens[i].type != TokenType::PREPROCESSOR)
+                continue;
+            string_view rest;
+            string_view word = directiveName(tokens[i].value, rest);
+            if (word == "pragma" && leadingIdentifier(rest) == "once")
+                guard.pragmaOnce = true;
+            else if (word == "if" || word == "ifdef" || word == "ifndef")
+            {
+                if (depth++ == 0 && i == 0)
+                    candidate = guardCondition(word, rest);
+            }
+            else if (word == "endif" && depth > 0)
+            {
+                if (--depth == 0 && !close)
+                    close = i;
+            }
+            else if (depth == 1 && word.substr(0, 2) == "el")
+                candidate = string_view(); // #else/#elif: not everything is guarded
+        }
 
-                expect(TokenType::RPAREN, ")");
+        if (candidate.empty() || n < 3 || close != n - 1 || tokens[1].type != TokenType::PREPROCESSOR)
+            return guard;
+        string_view rest;
+        if (directiveName(tokens[1].value, rest) == "define" && leadingIdentifier(rest) == candidate)
+            guard.macro = string(candidate);
+        return guard;
+    }
+};
 
-                // ------------------------------------
-                // ARGUMENT COUNT CHECK (UPDATED)
-                // ------------------------------------
-                string signature = stdLib.getFunctionSignature(idTok.value);
+struct HeaderUnit
+{
+    vector<Token> tokens; // without TOK_EOF
+    IncludeGuard guard;
+    filesystem::file_time_type modified;
+    uintmax_t size = 0;
+    size_t bytes = 0;     // memory held by tokens
+    uint64_t lastUse = 0; // HeaderCache clock at the last load()
+};
 
-                if (!signature.empty())
-                {
-                    size_t pos1 = signature.find("(");
-                    size_t pos2 = signature.find(")");
+// Headers lexed so far, by path; one is lexed again only after it changes on disk
+class HeaderCache
+{
+private:
+    unordered_map<string, HeaderUnit> units;
+    uint64_t clock = 0;
+    size_t total = 0; // sum of HeaderUnit::bytes
 
-                    if (pos1 != string::npos && pos2 != string::npos)
-                    {
-                        string params = signature.substr(pos1 + 1, pos2 - pos1 - 1);
+    static size_t bytesOf(const vector<Token> &tokens)
+    {
+        size_t bytes = tokens.capacity() * sizeof(Token);
+        for (const Token &t : tokens)
+            if (t.value.capacity() > string().capacity()) // past the small-string buffer
+                bytes += t.value.capacity() + 1;
+        return bytes;
+    }
 
-                        // A) VARIADIC FUNCTIONS
-                        if (params.find("...") != string::npos)
-                        {
-                            // Everything before the "..."
-                            string required = params.substr(0, params.find("..."));
-
-                            // Split required parameters by comma
-                            int requiredCount = 0;
-                            string token;
-                            stringstream ss(required);
-
-                            while (getline(ss, token, ','))
-                            {
-                                // Trim whitespace
-                                token.erase(0, token.find_first_not_of(" \t"));
-                                token.erase(token.find_last_not_of(" \t") + 1);
-
-                                if (!token.empty()) // only count real parameters
-                                    requiredCount++;
-                            }
-
-                            int provided = argTypes.size();
-
-                            if (provided < requiredCount)
-                            {
-                                errors.push_back({"Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
-                                                      " - Function '" + idTok.value +
-                                                      "' requires at least " + to_string(requiredCount) + " argument(s)",
-                                                  "SUGGESTION: Provide enough parameters before the variadic '...'"});
-                            }
-
-                            return "int"; // No further checks for variadic
-                        }
+public:
+    // nullptr when the header cannot be read
+    const HeaderUnit *load(const string &path)
+    {
+        error_code ec;
+        filesystem::file_time_type modified = filesystem::last_write_time(path, ec);
+        uintmax_t size = ec ? 0 : filesystem::file_size(path, ec);
+        if (ec)
+            return nullptr;
+
+        auto it = units.find(path);
+        if (it != units.end() && it->second.modified == modified && it->second.size == size)
+        {
+            it->second.lastUse = ++clock;
+            return &it->second;
+        }
 
-                        // ------------------------------------------------------------
-                        // B) FIXED-ARITY FUNCTIONS
-                        // ------------------------------------------------------------
-                        if (params != "void" && !params.empty())
-                        {
-                            int expected = std::count(params.begin(), params.end(), ',') + 1;
-                            int provided = argTypes.size();
-
-                            if (expected != provided)
-                            {
-                                errors.push_back({"Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
-                                                      " - Function call argument mismatch for '" + idTok.value + "'",
-                                                  "SUGGESTION: Expected " + to_string(expected) +
-                                                      " argument(s), but got " + to_string(provided)});
-                            }
-                        }
-                    }
-                }
+        SourceFile file;
+        if (!file.open(path) || file.isBinary())
+            return nullptr;
+        HeaderUnit &unit = units[path];
+        total -= unit.bytes;
+        unit.tokens = Lexer(file.text()).tokenizeAll();
+        unit.tokens.pop_back(); // TOK_EOF
+        unit.guard = IncludeGuard::detect(unit.tokens);
+        unit.modified = modified;
+        unit.size = size;
+        unit.bytes = bytesOf(unit.tokens);
+        unit.lastUse = ++clock;
+        total += unit.bytes;
+        return &unit;
+    }
 
-                // We don't track true return types yet → treat as int
-                return "int";
-            }
+    size_t bytes() const { return total; }
 
-            // ------------------------------------
-            // POSTFIX INC/DEC
-            // ------------------------------------
-            if (curr().type == TokenType::OP_INC || curr().type == TokenType::OP_DEC)
-            {
-                Token opTok = curr();
+    // Drops the least recently used headers until at most limit bytes remain;
+    // not while an IncludeExpander holds units
+    void trim(size_t limit)
+    {
+        if (total <= limit)
+            return;
+        vector<pair<uint64_t, const string *>> byUse;
+        for (const auto &entry : units)
+            byUse.push_back({entry.second.lastUse, &entry.first});
+        sort(byUse.begin(), byUse.end());
+        for (size_t i = 0; i < byUse.size() && total > limit; i++)
+        {
+            auto it = units.find(*byUse[i].second);
+            total -= it->second.bytes;
+            units.erase(it);
+        }
+    }
+};
 
-                // Validate lvalue
-                if (type == "function" || !isModifiableLvalue(idTok, type))
-                {
-                    string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                                    " - Invalid: cannot apply '" + opTok.value +
-                                    "' to '" + idTok.value + "' (not a modifiable lvalue)";
-                    errors.push_back({errMsg, "SUGGESTION: ++/-- require a modifiable variable"});
-                }
+// Gathers the headers a translation unit pulls in through quoted #includes,
+// transitively and relative to the including file, into one prelude of
+// tokens for the parser. Once a header's guard macro is defined, or it has
+// been read under #pragma once, including it again costs one lookup.
+class IncludeExpander
+{
+private:
+    static const int MAX_DEPTH = 200; // as GCC; stops unguarded include cycles
 
-                advance();
-            }
+    HeaderCache &cache;
+    unordered_map<string, const HeaderUnit *> seen; // checked against the disk once per unit
+    unordered_set<string> defined;                  // macro names, in include order
+    vector<Token> prelude;
+    vector<size_t> headerEnds;                      // prelude size after each header the file includes
 
-            return type;
-        }
+    static string directoryOf(const string &path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == string::npos ? string() : path.substr(0, slash + 1);
+    }
 
-        // ===============================
-        // NUMBER LITERAL
-        // ===============================
-        else if (t.type == TokenType::TOK_NUMBER)
+    void scan(const vector<Token> &tokens, const string &dir, int depth, bool intoPrelude)
+    {
+        for (const Token &t : tokens)
         {
-            advance();
-            if (t.value.find('.') != string::npos)
-                return "float";
-            return "int";
+            if (t.type == TokenType::TOK_EOF)
+                break;
+            if (intoPrelude)
+                prelude.push_back(t);
+            if (t.type != TokenType::PREPROCESSOR)
+                continue;
+
+            string_view rest;
+            string_view word = directiveName(t.value, rest);
+            if (word == "define")
+                defined.insert(string(leadingIdentifier(rest)));
+            else if (word == "undef")
+                defined.erase(string(leadingIdentifier(rest)));
+            else if (word == "include" && !rest.empty() && rest[0] == '"')
+            {
+                size_t end = rest.find('"', 1);
+                if (end != string_view::npos)
+                    include(filesystem::path(dir + string(rest.substr(1, end - 1))).lexically_normal().string(), depth);
+                if (depth == 0 && prelude.size() > (headerEnds.empty() ? 0 : headerEnds.back()))
+                    headerEnds.push_back(prelude.size());
+            }
         }
+    }
 
-        // ===============================
-        // STRING LITERAL
-        // ===============================
-        else if (t.type == TokenType::TOK_STRING)
+    void include(const string &path, int depth)
+    {
+        const HeaderUnit *unit;
+        auto it = seen.find(path);
+        if (it != seen.end())
         {
-            advance();
-            return "string";
+            unit = it->second;
+            if (!unit || unit->guard.pragmaOnce)
+                return;
         }
+        else if (!(unit = seen[path] = cache.load(path)))
+            return;
 
-        // ===============================
-        // CHAR LITERAL
-        // ===============================
-        else if (t.type == TokenType::TOK_CHAR)
+        if ((!unit->guard.macro.empty() && defined.count(unit->guard.macro)) || depth >= MAX_DEPTH)
+            return;
+        scan(unit->tokens, directoryOf(path), depth + 1, true);
+    }
+
+public:
+    explicit IncludeExpander(HeaderCache &headers) : cache(headers) {}
+
+    // The headers' tokens in include order; ends receives where each header
+    // included by the file itself stops (its nested includes are part of it)
+    vector<Token> expand(const vector<Token> &tokens, const string &path, vector<size_t> &ends)
+    {
+        scan(tokens, directoryOf(path), 0, false);
+        ends = move(headerEnds);
+        return move(prelude);
+    }
+};
+
+// ============================================================================
+// BASELINE MODULE (fingerprints of accepted diagnostics)
+// ============================================================================
+
+// A diagnostic's fingerprint ignores where it is: the code, the file path,
+// the message with numbers blanked and the tokens of the offending line.
+// Identical findings in one file are told apart by an occurrence counter.
+class Fingerprinter
+{
+private:
+    vector<uint64_t> lineHashes; // tokens of each source line
+    uint64_t pathHash;
+    unordered_map<uint64_t, uint32_t> seen;
+
+public:
+    static uint64_t fnv1a(const char *p, size_t n, uint64_t h = 14695981039346656037ULL)
+    {
+        for (size_t i = 0; i < n; i++)
+            h = (h ^ (unsigned char)p[i]) * 1099511628211ULL;
+        return h;
+    }
+
+    static uint64_t mix(uint64_t h, uint64_t v)
+    {
+        h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h * 0xff51afd7ed558ccdULL;
+    }
+
+    Fingerprinter(const vector<Token> &tokens, string path)
+    {
+        replace(path.begin(), path.end(), '\\', '/');
+        pathHash = fnv1a(path.data(), path.size());
+        for (const Token &t : tokens)
         {
-            advance();
-            return "char";
+            if (t.type == TokenType::TOK_EOF || t.line <= 0)
+                continue;
+            if ((size_t)t.line >= lineHashes.size())
+                lineHashes.resize(t.line + 1, 0);
+            uint64_t &h = lineHashes[t.line];
+            h = fnv1a(t.value.data(), t.value.size(), mix(h, (uint64_t)t.type));
         }
+    }
 
-        // ===============================
-        // PARENTHESIZED EXPRESSION
-        // ===============================
-        else if (t.type == TokenType::LPAREN)
+    uint64_t of(const string &message)
+    {
+        string shape;
+        shape.reserve(message.size());
+        for (size_t i = 0; i < message.size(); i++)
         {
-            advance();
-            string type = parseExpressionWithType();
-            expect(TokenType::RPAREN, ")");
-            return type;
+            if (!isdigit((unsigned char)message[i]))
+                shape += message[i];
+            else if (shape.empty() || shape.back() != '#')
+                shape += '#';
         }
+        const char *code = DiagnosticCodes::classify(message);
+        int line = DiagnosticCodes::lineOf(message);
+
+        uint64_t h = mix(fnv1a(code, strlen(code)), pathHash);
+        h = mix(h, fnv1a(shape.data(), shape.size()));
+        if (line > 0 && (size_t)line < lineHashes.size())
+            h = mix(h, lineHashes[line]);
+        h = mix(h, seen[h]++);
+        return h ? h : 1; // 0 marks an empty slot in the baseline table
+    }
+};
 
-        // ===============================
-        // ADDRESS-OF (&)
-        // ===============================
-        else if (t.type == TokenType::OP_BITAND)
-        {
-            Token opTok = curr();
-            advance();
+// On-disk open-addressing hash set of fingerprints, probed in place through
+// a memory map: "SCERSEB1", capacity (power of two), count, then the slots
+class BaselineFile
+{
+private:
+    static constexpr char MAGIC[8] = {'S', 'C', 'E', 'R', 'S', 'E', 'B', '1'};
+    static const size_t HEADER = 24;
 
-            if (curr().type != TokenType::TOK_IDENTIFIER)
-            {
-                string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                                " - Address-of operator & requires a variable";
-                errors.push_back({errMsg, "SUGGESTION: Use & with a variable. Example: &x"});
-                return "UNKNOWN";
-            }
+    MappedFile map;
+    const uint64_t *slots = nullptr;
+    uint64_t mask = 0;
 
-            Token idTok = curr();
-            string varType = sym.getType(idTok.value);
+    static uint64_t slotOf(uint64_t fingerprint, uint64_t mask) { return (fingerprint ^ (fingerprint >> 29)) & mask; }
 
-            if (!sym.exists(idTok.value))
-            {
-                string errMsg = "Line " + to_string(idTok.line) + ":" + to_string(idTok.column) +
-                                " - Undeclared variable '" + idTok.value + "'";
-                errors.push_back({errMsg, suggestionEngine.getSuggestion(errMsg)});
-            }
+public:
+    bool loaded() const { return slots != nullptr; }
 
-            advance();
-            return varType + "*";
+    bool load(const string &path)
+    {
+        slots = nullptr;
+        if (!map.open(path) || map.size() < HEADER || memcmp(map.data(), MAGIC, 8) != 0)
+            return false;
+        uint64_t capacity, count;
+        memcpy(&capacity, map.data() + 8, 8);
+        memcpy(&count, map.data() + 16, 8);
+        if (capacity == 0 || (capacity & (capacity - 1)))
+            return false;
+        // divide before multiplying: a forged capacity must not wrap the size check
+        if (capacity > (map.size() - HEADER) / 8 || map.size() != HEADER + capacity * 8)
+            return false;
+        if (count >= capacity) // a full table has no empty slot to end a probe
+            return false;
+        slots = (const uint64_t *)(map.data() + HEADER); // page-aligned map + 24: 8-byte aligned
+        mask = capacity - 1;
+        return true;
+    }
+
+    bool contains(uint64_t fingerprint) const
+    {
+        if (!slots)
+            return false;
+        // bounded: the stored count is not trusted to match the slots
+        uint64_t i = slotOf(fingerprint, mask);
+        for (uint64_t probes = 0; probes <= mask; probes++, i = (i + 1) & mask)
+        {
+            if (slots[i] == fingerprint)
+                return true;
+            if (slots[i] == 0)
+                return false;
         }
+        return false;
+    }
 
-        // ===============================
-        // PREFIX UNARY OPS
-        // ===============================
-        else if (t.type == TokenType::OP_PLUS ||
-                 t.type == TokenType::OP_MINUS ||
-                 t.type == TokenType::OP_NOT ||
-                 t.type == TokenType::OP_BITNOT)
+    static bool write(const string &path, const vector<uint64_t> &fingerprints)
+    {
+        uint64_t capacity = 16;
+        while (capacity < fingerprints.size() * 2)
+            capacity <<= 1;
+
+        vector<uint64_t> table(capacity, 0);
+        uint64_t count = 0;
+        for (uint64_t fp : fingerprints)
         {
-            Token opTok = curr();
-            advance();
+            uint64_t i = slotOf(fp, capacity - 1);
+            while (table[i] != 0 && table[i] != fp)
+                i = (i + 1) & (capacity - 1);
+            if (table[i] == 0)
+                count++;
+            table[i] = fp;
+        }
 
-            // Detect nonsense like +*- or -/ or !~+
-            if (curr().type == TokenType::OP_PLUS ||
-                curr().type == TokenType::OP_MINUS ||
-                curr().type == TokenType::OP_STAR ||
-                curr().type == TokenType::OP_SLASH ||
-                curr().type == TokenType::OP_PERCENT ||
-                curr().type == TokenType::OP_BITAND ||
-                curr().type == TokenType::OP_BITOR ||
-                curr().type == TokenType::OP_BITXOR)
-            {
-                string err =
-                    "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                    " - Invalid operator sequence starting at '" + opTok.value + "'";
-                errors.push_back({err,
-                                  "SUGGESTION: Unary operators must be followed by a valid expression"});
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out)
+            return false;
+        out.write(MAGIC, 8);
+        out.write((const char *)&capacity, 8);
+        out.write((const char *)&count, 8);
+        out.write((const char *)table.data(), capacity * 8);
+        return (bool)out;
+    }
+};
 
-                advance(); // skip garbage
-                return "UNKNOWN";
-            }
+// ============================================================================
+// ANALYSIS ENGINE (Qt-ready public API)
+// ============================================================================
 
-            // ERROR: operand missing
-            if (curr().type == TokenType::SEMICOLON ||
-                curr().type == TokenType::RPAREN ||
-                curr().type == TokenType::RBRACE ||
-                curr().type == TokenType::COMMA)
-            {
-                errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                                      " - Incomplete unary expression after '" + opTok.value + "'",
-                                  "SUGGESTION: Provide a valid operand"});
-                return "UNKNOWN";
-            }
+// Which checks an engine runs; each profile uses its own parser instantiation
+enum class AnalysisProfile
+{
+    Full,      // syntax, semantic checks, rules and clone detection
+    SyntaxOnly // syntax errors only (CI gate)
+};
 
-            // ===================================================
-            // NEW: block unary +, -, !, ~ on FUNCTION identifiers
-            // ===================================================
-            if (curr().type == TokenType::TOK_IDENTIFIER)
-            {
-                string id = curr().value;
-                string idType = sym.getType(id);
+class CErrorDetectorEngine
+{
+private:
+    StringInterner ids = StandardLibrary::newInterner(); // names and types of this engine's analyses
+    size_t minCloneTokens;
+    RuleEngine rules;
+    bool profileRules = false;
+    AnalysisProfile profile = AnalysisProfile::Full;
+    TargetABI target = TargetABI::SysV_x86_64;
+    BaselineFile baseline;
+    bool recordingBaseline = false;
+    vector<uint64_t> recordedFingerprints;
+    HeaderCache headers;
+    CallGraphReport callGraph;
+    WorkspaceIndex workspace; // every file analyzed by path, kept across analyses
+
+    bool usesFingerprints() const { return recordingBaseline || baseline.loaded(); }
+
+    // Records fingerprints for a new baseline and hides findings already in the loaded one
+    void applyBaseline(AnalysisResult &result, Fingerprinter &fingerprints)
+    {
+        auto keep = [&](const string &message)
+        {
+            uint64_t fp = fingerprints.of(message);
+            if (recordingBaseline)
+                recordedFingerprints.push_back(fp);
+            if (!baseline.contains(fp))
+                return true;
+            result.baselined++;
+            return false;
+        };
 
-                if (idType == "function")
-                {
-                    errors.push_back({"Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                                          " - Unary operator '" + opTok.value +
-                                          "' cannot be applied to function '" + id + "'",
-                                      "SUGGESTION: Functions must be called normally, e.g. " + id + "();"});
+        size_t kept = 0;
+        for (size_t i = 0; i < result.lexicalErrors.size(); i++)
+            if (keep(result.lexicalErrors[i]))
+                result.lexicalErrors[kept++] = move(result.lexicalErrors[i]);
+        result.lexicalErrors.resize(kept);
 
-                    advance();
-                    return "UNKNOWN";
-                }
-            }
+        kept = 0;
+        for (size_t i = 0; i < result.syntaxErrors.size(); i++)
+            if (keep(result.syntaxErrors[i].first))
+                result.syntaxErrors[kept++] = move(result.syntaxErrors[i]);
+        result.syntaxErrors.resize(kept);
 
-            return parsePrimaryWithType();
-        }
+        result.totalErrors = result.lexicalErrors.size() + result.syntaxErrors.size();
+    }
 
-        // ===============================
-        // BAD BINARY OP AT START
-        // ===============================
-        else if (t.type == TokenType::OP_EQ || t.type == TokenType::OP_NE ||
-                 t.type == TokenType::OP_AND || t.type == TokenType::OP_OR)
+    template <typename Policy>
+    void parseWith(const vector<Token> &tokens, const vector<Token> &prelude, const vector<size_t> &headerEnds,
+                   AnalysisResult &result, UnitSummary &summary)
+    {
+        vector<Token> unit;
+        if (!prelude.empty())
         {
-            Token opTok = curr();
-            string errMsg = "Line " + to_string(opTok.line) + ":" + to_string(opTok.column) +
-                            " - Invalid: operator '" + opTok.value + "' cannot start an expression";
-            errors.push_back({errMsg, "SUGGESTION: Add a left operand"});
-            advance();
-            return "UNKNOWN";
+            unit.reserve(prelude.size() + tokens.size());
+            unit.insert(unit.end(), prelude.begin(), prelude.end());
+            unit.insert(unit.end(), tokens.begin(), tokens.end());
         }
-        // ==========================================================
-        // STEP 5: Detect two consecutive primaries without an operator
-        // ==========================================================
-        if (curr().type == TokenType::TOK_IDENTIFIER ||
-            curr().type == TokenType::TOK_NUMBER ||
-            curr().type == TokenType::TOK_STRING ||
-            curr().type == TokenType::TOK_CHAR)
+        ParserT<Policy> parser(prelude.empty() ? tokens : unit, headerEnds);
+        parser.setTarget(target);
+        parser.parseProgram();
+        result.syntaxErrors = parser.getErrorsWithSuggestions();
+        result.functionMetrics = parser.getFunctionMetrics();
+        result.structLayouts = parser.getStructLayouts();
+        summary = move(parser.getSummary());
+
+        if (profile == AnalysisProfile::Full)
         {
-            Token bad = curr();
-            string err =
-                "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                " - Unexpected token '" + bad.value + "' after expression";
-            errors.push_back({err,
-                              "SUGGESTION: Missing operator between expressions"});
-
-            advance(); // Prevent infinite loop
+            rules.run(parser.getTokens(), parser.getRuleNodes(), result.syntaxErrors, prelude.size());
+            if (profileRules)
+                result.ruleTimings = rules.getTimings();
         }
+    }
+
+    static AnalysisResult openFailure(const string &filename)
+    {
+        AnalysisResult result;
+        result.lexicalErrors.push_back("ERROR: Could not open file '" + filename + "'");
+        result.totalErrors = 1;
+        return result;
+    }
 
-        // ===============================
-        // FALLBACK
-        // ===============================
-        return "UNKNOWN";
+    // Rejected from its first bytes instead of being lexed into error tokens
+    static AnalysisResult binaryFailure(const string &filename)
+    {
+        AnalysisResult result;
+        result.lexicalErrors.push_back("ERROR: '" + filename + "' is a binary file, not C source");
+        result.totalErrors = 1;
+        return result;
     }
 
-    bool isModifiableLvalue(const Token &token, const string &symType)
+    // Lex and parse one translation unit; the token stream and the unit
+    // summary are handed back for the clone detector and the whole-program
+    // checks. With a path, declarations of the headers it #includes "..."
+    // are visible.
+    AnalysisResult analyzeSource(string_view sourceCode, const string &path, vector<Token> &tokens,
+                                 SuppressionIndex &suppressions, UnitSummary &summary)
     {
-        // A modifiable lvalue for ++/-- must be:
-        // 1. An identifier (not a literal)
-        // 2. A VARIABLE type, not a function
-        // 3. NOT a standard library function
-        // 4. NOT a user-defined function (symType would be "function")
-        // 5. A complete object type (not incomplete/function type)
+        AnalysisResult result;
 
-        if (token.type != TokenType::TOK_IDENTIFIER)
-        {
-            return false; // Literals are not lvalues
-        }
+        Lexer lexer(sourceCode);
+        tokens = lexer.tokenizeAll();
+        result.lexicalErrors = lexer.getErrors();
+        suppressions = lexer.getSuppressions();
 
-        // REJECT: User-defined functions
-        if (symType == "function")
-        {
-            return false; // Cannot apply ++/-- to functions
-        }
+        vector<Token> prelude;
+        vector<size_t> headerEnds;
+        if (!path.empty())
+            prelude = IncludeExpander(headers).expand(tokens, path, headerEnds);
 
-        // REJECT: Standard library functions
-        if (stdLib.isStdioFunction(token.value) ||
-            stdLib.isStdlibFunction(token.value) ||
-            stdLib.isStringFunction(token.value) ||
-            stdLib.isMathFunction(token.value))
-        {
-            return false; // Standard library functions are not modifiable lvalues
-        }
+        if (profile == AnalysisProfile::SyntaxOnly)
+            parseWith<SyntaxOnlyChecks>(tokens, prelude, headerEnds, result, summary);
+        else
+            parseWith<FullChecks>(tokens, prelude, headerEnds, result, summary);
 
-        // REJECT: Undeclared or unknown type
-        if (symType == "UNKNOWN" || symType == "" || (symType == "int" && !sym.exists(token.value)))
-        {
-            return false; // Not a declared variable
-        }
+        result.totalErrors = result.lexicalErrors.size() + result.syntaxErrors.size();
+        return result;
+    }
 
-        // ACCEPT: It's a declared variable with a concrete type
-        return true;
+    // Drops diagnostics silenced by scerse-ignore comments; run last so
+    // batch-level findings (clones) are covered too
+    static void applySuppressions(AnalysisResult &result, SuppressionIndex &suppressions)
+    {
+        if (suppressions.empty())
+            return;
+        suppressions.filter(result.lexicalErrors, [](const string &e) -> const string &
+                            { return e; });
+        suppressions.filter(result.syntaxErrors, [](const pair<string, string> &e) -> const string &
+                            { return e.first; });
+        result.totalErrors = result.lexicalErrors.size() + result.syntaxErrors.size();
     }
 
-    string parseExpressionWithFullType()
+    // Reduce step over the per-file call edges: fan-in/fan-out go into the
+    // function metrics, cycles and unreachable functions into callGraph
+    void buildCallGraph(const vector<string> &names, const vector<size_t> &resultIndex,
+                        const vector<UnitSummary> &units, vector<AnalysisResult> &results)
     {
-        string lhs = parsePrimaryWithType();
+        callGraph = CallGraphReport();
+        if (profile != AnalysisProfile::Full)
+            return;
 
-        while (isValidBinaryOp(curr().type))
+        CallGraph graph;
+        for (size_t f = 0; f < names.size(); f++)
+            graph.addFile(results[resultIndex[f]].functionMetrics, units[f].calls, units[f].staticFunctions);
+        graph.build();
+
+        for (size_t f = 0; f < names.size(); f++)
         {
-            // ===============================
-            // INVALID OPERATOR SEQUENCE CHECK
-            // ===============================
-            if (((curr().type == TokenType::OP_NOT || curr().type == TokenType::OP_ASSIGN || peek().type == TokenType::OP_EQ) &&
-                 (curr().type == TokenType::OP_ASSIGN || peek().type == TokenType::OP_EQ)) ||
-                ((curr().type == TokenType::OP_EQ) &&
-                 (peek().type == TokenType::OP_LE || peek().type == TokenType::OP_GE || peek().type == TokenType::OP_LT || peek().type == TokenType::OP_GT)))
+            vector<FunctionMetrics> &metrics = results[resultIndex[f]].functionMetrics;
+            for (size_t i = 0; i < metrics.size(); i++)
             {
-                // This is the pattern: ! = =  (user typed !==)
-                Token bad = curr();
-                string err = "Line " + to_string(bad.line) + ":" + to_string(bad.column) +
-                             " - Invalid operator sequence:  sequences like '!==' or '===' are not valid in C";
-                errors.push_back({err, "SUGGESTION: Use '!=' for inequality or '==' for equality"});
-
-                // Skip the extra =
-                advance();
+                uint32_t node = graph.nodeOfMetric(f, i);
+                metrics[i].fanIn = graph.fanInOf(node);
+                metrics[i].fanOut = graph.fanOutOf(node);
             }
+        }
 
-            Token op = curr();
-            advance();
+        auto byPosition = [](const SymbolRef &a, const SymbolRef &b)
+        { return tie(a.file, a.line) < tie(b.file, b.line); };
+        for (const vector<uint32_t> &component : graph.recursiveComponents())
+        {
+            vector<SymbolRef> &cycle = callGraph.cycles.emplace_back();
+            for (uint32_t node : component)
+                cycle.push_back(graph.describe(node, names));
+            sort(cycle.begin(), cycle.end(), byPosition);
+        }
+        sort(callGraph.cycles.begin(), callGraph.cycles.end(), [&](const auto &a, const auto &b)
+             { return byPosition(a[0], b[0]); });
+        for (uint32_t node : graph.unreachable())
+            callGraph.unreachable.push_back(graph.describe(node, names));
+        sort(callGraph.unreachable.begin(), callGraph.unreachable.end(), byPosition);
+    }
 
-            string rhs = parsePrimaryWithType();
+    // Reduce step over the per-file external symbol tables: every file's view
+    // of a name is compared with its definition (or first declaration), and
+    // definitions after the first are reported where they occur. Conflicts
+    // inside one file are left to the parser.
+    void checkExternals(const vector<string> &names, const vector<size_t> &resultIndex,
+                        const vector<UnitSummary> &units, vector<AnalysisResult> &results)
+    {
+        if (profile != AnalysisProfile::Full || units.size() < 2)
+            return;
 
-            // If any side is UNKNOWN → carry on but do not error
-            if (lhs != "UNKNOWN" && rhs != "UNKNOWN")
-            {
-                string result = TypeSystem::getOperationResultType(lhs, rhs, op.value);
+        struct Entry
+        {
+            const ExternalSymbol *symbol;
+            uint32_t file;
+        };
+        vector<Entry> entries;
+        for (size_t f = 0; f < units.size(); f++)
+            for (const ExternalSymbol &e : units[f].externals)
+                entries.push_back({&e, (uint32_t)f});
+        stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+                    { return a.symbol->name < b.symbol->name; });
+
+        StringInterner &ids = StringInterner::current();
+        auto where = [&](const Entry &e)
+        { return "'" + names[e.file] + "' (line " + to_string(e.symbol->line) + ")"; };
+
+        for (size_t first = 0, last; first < entries.size(); first = last)
+        {
+            last = first + 1;
+            while (last < entries.size() && entries[last].symbol->name == entries[first].symbol->name)
+                last++;
 
-                if (result == "INVALID")
+            size_t ref = first;
+            for (size_t i = first; i < last; i++)
+                if (entries[i].symbol->definition)
                 {
-                    string err =
-                        "Line " + to_string(op.line) + ":" + to_string(op.column) +
-                        " - Type mismatch: cannot apply operator '" + op.value +
-                        "' between '" + lhs + "' and '" + rhs + "'";
-                    errors.push_back({err,
-                                      "SUGGESTION: Convert operands or use compatible types."});
+                    ref = i;
+                    break;
                 }
+            const Entry &r = entries[ref];
+            const string &name = ids.name(r.symbol->name);
+
+            for (size_t i = first; i < last; i++)
+            {
+                const Entry &e = entries[i];
+                if (e.file == r.file)
+                    continue;
+                AnalysisResult &result = results[resultIndex[e.file]];
+                string at = "Line " + to_string(e.symbol->line) + ":" + to_string(e.symbol->column) + " - ";
+
+                if (e.symbol->type != r.symbol->type)
+                    result.syntaxErrors.push_back(
+                        {"Warning: " + at + "'" + name + "' as '" + ids.name(e.symbol->type) + "' conflicts with its " +
+                             (r.symbol->definition ? "definition" : "declaration") + " as '" +
+                             ids.name(r.symbol->type) + "' in " + where(r),
+                         "SUGGESTION: Declare '" + name + "' once in a header that every file using it includes"});
+                else if (e.symbol->definition && r.symbol->definition)
+                    result.syntaxErrors.push_back(
+                        {at + "'" + name + "' is also defined in " + where(r),
+                         "SUGGESTION: Keep one definition; declare it extern elsewhere, or make each copy static"});
                 else
-                {
-                    lhs = result;
-                }
+                    continue;
+                result.totalErrors++;
             }
         }
-
-        return lhs;
     }
 
-public:
-    Parser(const vector<Token> &toks) : tokens(toks), index(0), lastIndex(0) {}
-
-    void parseProgram()
+    // Each clone is reported once, on the later copy
+    void reportClones(const CloneDetector &clones, const vector<string> &names, const vector<size_t> &resultIndex,
+                      vector<AnalysisResult> &results)
     {
-        int maxIter = 10000;
-        int iter = 0;
-        while (curr().type != TokenType::TOK_EOF && iter++ < maxIter)
+        if (profile != AnalysisProfile::Full)
+            return;
+        for (const ClonePair &c : clones.findClones())
         {
-            lastIndex = index;
-            if (curr().type == TokenType::PREPROCESSOR)
-            {
-                advance();
-            }
-            if (curr().type == TokenType::KW_TYPEDEF)
-            {
-                parseTypedef();
-                forceAdvance();
-                continue;
-            }
-            if (curr().type == TokenType::KW_STRUCT)
-            {
-                parseStruct();
-                forceAdvance();
-                continue;
-            }
-            else if (isTypeToken(curr()))
-                parseDeclOrFunc();
-            else if (curr().type == TokenType::TOK_ERROR)
-                advance();
-            else
-            {
-                Token bad = curr();
-                string errMsg = "Line " + to_string(bad.line) + ":" + to_string(bad.column) + " - Unexpected at file scope";
-                string sug = suggestionEngine.getSuggestion(errMsg);
-                errors.push_back({errMsg, sug});
-                advance();
-            }
-            forceAdvance();
+            string where = "lines " + to_string(c.first.line) + "-" + to_string(c.first.endLine);
+            if (c.first.file != c.second.file)
+                where += " of '" + names[c.first.file] + "'";
+
+            AnalysisResult &r = results[resultIndex[c.second.file]];
+            r.syntaxErrors.push_back({"Warning: Line " + to_string(c.second.line) + ":" + to_string(c.second.column) +
+                                          " - Duplicated code (" + to_string(c.tokenCount) + " tokens, lines " +
+                                          to_string(c.second.line) + "-" + to_string(c.second.endLine) +
+                                          ") matches " + where,
+                                      "SUGGESTION: Move the repeated code into a shared function"});
+            r.totalErrors++;
         }
-        if (iter >= maxIter)
-            errors.push_back({"Parser stuck - aborting", ""});
     }
 
-    vector<pair<string, string>> getErrorsWithSuggestions() const { return errors; }
-};
+public:
+    CErrorDetectorEngine(size_t cloneThreshold = 50) : minCloneTokens(cloneThreshold)
+    {
+        rules.addRule(make_unique<UnsafeFunctionRule>());
+        rules.addRule(make_unique<AssignmentInConditionRule>());
+        rules.addRule(make_unique<OctalLiteralRule>());
+        rules.addRule(make_unique<StrlenInLoopConditionRule>());
+        rules.addRule(make_unique<StrcatInLoopRule>());
+        rules.addRule(make_unique<AllocationInLoopRule>());
+        rules.addRule(make_unique<LargeStructByValueRule>());
+    }
 
-// ============================================================================
-// ANALYSIS ENGINE (Qt-ready public API)
-// ============================================================================
+    ~CErrorDetectorEngine() {}
 
-class CErrorDetectorEngine
-{
-private:
-    Lexer *lexer;
-    Parser *parser;
+    // Minimum length, in tokens, of a duplicated region worth reporting (0 disables)
+    void setCloneThreshold(size_t tokens) { minCloneTokens = tokens; }
 
-public:
-    CErrorDetectorEngine() : lexer(nullptr), parser(nullptr) {}
+    void setProfile(AnalysisProfile p) { profile = p; }
+
+    // Sizes and alignments used for struct layouts and sizeof
+    void setTargetABI(TargetABI abi) { target = abi; }
 
-    ~CErrorDetectorEngine()
+    // Later analyses only report diagnostics whose fingerprint is not in the file
+    bool loadBaseline(const string &path) { return baseline.load(path); }
+
+    // Collect fingerprints of everything reported from now on, for writeBaseline()
+    void recordBaseline(bool on)
     {
-        if (lexer)
-            delete lexer;
-        if (parser)
-            delete parser;
+        recordingBaseline = on;
+        recordedFingerprints.clear();
     }
 
-    AnalysisResult analyzeCode(const string &sourceCode)
+    bool writeBaseline(const string &path) const { return BaselineFile::write(path, recordedFingerprints); }
+
+    // Additional checks run alongside the built-in rules
+    void addRule(unique_ptr<Rule> rule) { rules.addRule(move(rule)); }
+
+    // Turns a rule on or off by name; false if no rule has that name
+    bool setRuleEnabled(const string &name, bool on) { return rules.setEnabled(name, on); }
+
+    // Recursion cycles and unreachable functions found by the last analysis
+    const CallGraphReport &getCallGraph() const { return callGraph; }
+
+    // Non-static functions and globals that no file analyzed so far refers
+    // to. Analyzing a file again, or forgetFile(), updates only its share.
+    vector<SymbolRef> getUnusedSymbols()
     {
-        AnalysisResult result;
+        StringInterner::Use use(ids);
+        return workspace.unused();
+    }
 
-        lexer = new Lexer(sourceCode);
-        vector<Token> tokens = lexer->tokenizeAll();
-        result.lexicalErrors = lexer->getErrors();
+    void forgetFile(const string &path) { workspace.remove(path); }
 
-        parser = new Parser(tokens);
-        parser->parseProgram();
-        vector<pair<string, string>> syntaxErrors = parser->getErrorsWithSuggestions();
-        result.syntaxErrors = syntaxErrors;
+    // Memory held between analyses by lexed headers and interned names, and a
+    // cap on it; the names back the workspace index, so headers go first (LRU)
+    size_t cachedBytes() const { return headers.bytes() + ids.bytes(); }
+    void trimCache(size_t bytes) { headers.trim(bytes > ids.bytes() ? bytes - ids.bytes() : 0); }
 
-        result.totalErrors = result.lexicalErrors.size() + result.syntaxErrors.size();
+    // Record the time spent in each rule into AnalysisResult::ruleTimings
+    void setRuleProfiling(bool on)
+    {
+        profileRules = on;
+        rules.setProfiling(on);
+    }
 
-        return result;
+    AnalysisResult analyzeCode(string_view sourceCode) { return analyzeCode(sourceCode, ""); }
+
+    // path, when known, locates the headers the code #includes "..."
+    AnalysisResult analyzeCode(string_view sourceCode, const string &path)
+    {
+        StringInterner::Use use(ids);
+        vector<Token> tokens;
+        SuppressionIndex suppressions;
+        vector<UnitSummary> units(1);
+        vector<AnalysisResult> results{analyzeSource(sourceCode, path, tokens, suppressions, units[0])};
+
+        CloneDetector clones(minCloneTokens);
+        clones.addFile(tokens);
+        reportClones(clones, {""}, {0}, results);
+        buildCallGraph({path}, {0}, units, results);
+        if (!path.empty())
+            workspace.update(path, units[0], results[0].functionMetrics);
+        applySuppressions(results[0], suppressions);
+        if (usesFingerprints())
+        {
+            Fingerprinter fingerprints(tokens, "");
+            applyBaseline(results[0], fingerprints);
+        }
+        return results[0];
     }
 
+    // A UTF-8 file is lexed straight from its mapping, CRLF or not; UTF-16,
+    // UTF-32 and Latin-1 files are transcoded to UTF-8 first
     AnalysisResult analyzeFile(const string &filename)
     {
-        ifstream f(filename);
-        if (!f.is_open())
+        SourceFile file;
+        if (!file.open(filename))
+            return openFailure(filename);
+        if (file.isBinary())
+            return binaryFailure(filename);
+        return analyzeCode(file.text(), filename);
+    }
+
+    // Analyzes every file and looks for code duplicated within or across them
+    vector<AnalysisResult> analyzeFiles(const vector<string> &filenames)
+    {
+        StringInterner::Use use(ids);
+        vector<AnalysisResult> results;
+        vector<SuppressionIndex> suppressions(filenames.size());
+        vector<string> names;       // per clone-detector file
+        vector<size_t> resultIndex; // clone-detector file -> results slot
+        vector<Fingerprinter> fingerprints; // per clone-detector file, in baseline mode
+        vector<UnitSummary> units;          // per clone-detector file
+        CloneDetector clones(minCloneTokens);
+
+        for (const string &filename : filenames)
         {
-            AnalysisResult result;
-            result.lexicalErrors.push_back("ERROR: Could not open file '" + filename + "'");
-            result.totalErrors = 1;
-            return result;
+            SourceFile file;
+            if (!file.open(filename) || file.isBinary())
+            {
+                results.push_back(file.isBinary() ? binaryFailure(filename) : openFailure(filename));
+                continue;
+            }
+            vector<Token> tokens;
+            results.push_back(analyzeSource(file.text(), filename, tokens,
+                                            suppressions[results.size()], units.emplace_back()));
+            clones.addFile(tokens);
+            if (usesFingerprints())
+                fingerprints.emplace_back(tokens, filename);
+            names.push_back(filename);
+            resultIndex.push_back(results.size() - 1);
         }
-        string code((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
-        return analyzeCode(code);
+
+        reportClones(clones, names, resultIndex, results);
+        buildCallGraph(names, resultIndex, units, results);
+        checkExternals(names, resultIndex, units, results);
+        for (size_t f = 0; f < names.size(); f++)
+            workspace.update(names[f], units[f], results[resultIndex[f]].functionMetrics);
+        for (size_t i = 0; i < results.size(); i++)
+            applySuppressions(results[i], suppressions[i]);
+        for (size_t f = 0; f < fingerprints.size(); f++)
+            applyBaseline(results[resultIndex[f]], fingerprints[f]);
+        return results;
     }
 };
 
 // ============================================================================
-// MAIN INTERFACE (for testing without Qt)
+// MAIN INTERFACE (command-line analyzer, built without Qt with -DSCERSE_CLI)
 // ============================================================================
 
-/*int main() {
-    cout << "\n" << string(70, '=') << endl;
-    cout << "  C ERROR DETECTOR WITH SUGGESTION ENGINE (Qt-Ready)" << endl;
-    cout << string(70, '=') << "\n" << endl;
+#ifdef SCERSE_CLI
 
-    CErrorDetectorEngine engine;
+static string jsonEscape(const string &s)
+{
+    string out;
+    for (char c : s)
+    {
+        switch (c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            }
+            else
+                out += c;
+        }
+    }
+    return out;
+}
+
+static void printJsonRef(const SymbolRef &f)
+{
+    cout << "{\"name\": \"" << jsonEscape(f.name) << "\", \"path\": \"" << jsonEscape(f.file)
+         << "\", \"line\": " << f.line << "}";
+}
+
+static void printJson(const vector<pair<string, AnalysisResult>> &results, const CallGraphReport &graph,
+                      const vector<SymbolRef> &unused)
+{
+    cout << "{\n  \"files\": [";
+    for (size_t f = 0; f < results.size(); f++)
+    {
+        const AnalysisResult &r = results[f].second;
+        cout << (f ? "," : "") << "\n    {\n      \"path\": \"" << jsonEscape(results[f].first) << "\",\n";
+
+        cout << "      \"lexicalErrors\": [";
+        for (size_t i = 0; i < r.lexicalErrors.size(); i++)
+            cout << (i ? ", " : "") << "\"" << jsonEscape(r.lexicalErrors[i]) << "\"";
+        cout << "],\n";
+
+        cout << "      \"syntaxErrors\": [";
+        for (size_t i = 0; i < r.syntaxErrors.size(); i++)
+        {
+            cout << (i ? "," : "") << "\n        {\"message\": \"" << jsonEscape(r.syntaxErrors[i].first)
+                 << "\", \"code\": \"" << DiagnosticCodes::classify(r.syntaxErrors[i].first)
+                 << "\", \"suggestion\": \"" << jsonEscape(r.syntaxErrors[i].second) << "\"}";
+        }
+        cout << (r.syntaxErrors.empty() ? "" : "\n      ") << "],\n";
+
+        cout << "      \"functions\": [";
+        for (size_t i = 0; i < r.functionMetrics.size(); i++)
+        {
+            const FunctionMetrics &m = r.functionMetrics[i];
+            cout << (i ? "," : "") << "\n        {\"name\": \"" << jsonEscape(m.name) << "\", \"line\": " << m.line
+                 << ", \"cyclomaticComplexity\": " << m.cyclomaticComplexity
+                 << ", \"maxNestingDepth\": " << m.maxNestingDepth
+                 << ", \"statementCount\": " << m.statementCount
+                 << ", \"fanIn\": " << m.fanIn << ", \"fanOut\": " << m.fanOut << "}";
+        }
+        cout << (r.functionMetrics.empty() ? "" : "\n      ") << "],\n";
+
+        cout << "      \"structs\": [";
+        for (size_t i = 0; i < r.structLayouts.size(); i++)
+        {
+            const StructLayout &l = r.structLayouts[i];
+            cout << (i ? "," : "") << "\n        {\"name\": \"" << jsonEscape(l.name) << "\", \"line\": " << l.line
+                 << ", \"size\": " << l.size << ", \"align\": " << l.align << ", \"padding\": " << l.padding
+                 << ", \"optimalSize\": " << l.optimalSize << ", \"straddling\": [";
+            for (size_t m = 0; m < l.straddling.size(); m++)
+                cout << (m ? ", " : "") << "\"" << jsonEscape(l.straddling[m]) << "\"";
+            cout << "]}";
+        }
+        cout << (r.structLayouts.empty() ? "" : "\n      ") << "],\n";
 
-    cout << "Enter the path to a C source file: ";
-    string filename;
-    getline(cin, filename);
+        if (!r.ruleTimings.empty())
+        {
+            cout << "      \"ruleTimings\": [";
+            for (size_t i = 0; i < r.ruleTimings.size(); i++)
+            {
+                const RuleTiming &t = r.ruleTimings[i];
+                cout << (i ? "," : "") << "\n        {\"rule\": \"" << jsonEscape(t.rule)
+                     << "\", \"milliseconds\": " << t.milliseconds << ", \"calls\": " << t.calls << "}";
+            }
+            cout << "\n      ],\n";
+        }
 
-    if (filename.empty()) {
-        cout << "No file specified.\n";
-        return 1;
+        cout << "      \"baselined\": " << r.baselined << ",\n";
+        cout << "      \"totalErrors\": " << r.totalErrors << "\n    }";
+    }
+    cout << "\n  ],\n  \"callGraph\": {\n    \"cycles\": [";
+    for (size_t c = 0; c < graph.cycles.size(); c++)
+    {
+        cout << (c ? "," : "") << "\n      [";
+        for (size_t i = 0; i < graph.cycles[c].size(); i++)
+        {
+            cout << (i ? ", " : "");
+            printJsonRef(graph.cycles[c][i]);
+        }
+        cout << "]";
+    }
+    cout << (graph.cycles.empty() ? "" : "\n    ") << "],\n    \"unreachable\": [";
+    for (size_t i = 0; i < graph.unreachable.size(); i++)
+    {
+        cout << (i ? "," : "") << "\n      ";
+        printJsonRef(graph.unreachable[i]);
+    }
+    cout << (graph.unreachable.empty() ? "" : "\n    ") << "]\n  },\n  \"unused\": [";
+    for (size_t i = 0; i < unused.size(); i++)
+    {
+        cout << (i ? "," : "") << "\n    ";
+        printJsonRef(unused[i]);
     }
+    cout << (unused.empty() ? "" : "\n  ") << "]\n}\n";
+}
 
-    AnalysisResult result = engine.analyzeFile(filename);
+static void printText(const string &path, const AnalysisResult &result, bool layouts)
+{
+    cout << "\n" << string(70, '=') << "\n  " << path << "\n" << string(70, '=') << "\n";
 
-    if (!result.lexicalErrors.empty()) {
+    if (!result.lexicalErrors.empty())
+    {
         cout << "\nLEXICAL ERRORS (" << result.lexicalErrors.size() << "):\n";
         cout << string(70, '-') << "\n";
-        for (const auto& e : result.lexicalErrors) {
+        for (const auto &e : result.lexicalErrors)
             cout << "  " << e << "\n";
-        }
     }
 
-    if (!result.syntaxErrors.empty()) {
+    if (!result.syntaxErrors.empty())
+    {
         cout << "\nSYNTAX/SEMANTIC ERRORS (" << result.syntaxErrors.size() << "):\n";
         cout << string(70, '-') << "\n";
-        for (size_t i = 0; i < result.syntaxErrors.size(); ++i) {
-            cout << "[" << (i+1) << "] " << result.syntaxErrors[i].first << "\n";
-            if (!result.syntaxErrors[i].second.empty()) {
+        for (size_t i = 0; i < result.syntaxErrors.size(); ++i)
+        {
+            cout << "[" << (i + 1) << "] " << result.syntaxErrors[i].first << "\n";
+            if (!result.syntaxErrors[i].second.empty())
                 cout << "    " << result.syntaxErrors[i].second << "\n";
-            }
+        }
+    }
+
+    if (!result.functionMetrics.empty())
+    {
+        cout << "\nFUNCTION METRICS (complexity / nesting / statements / fan-in / fan-out):\n";
+        cout << string(70, '-') << "\n";
+        for (const auto &m : result.functionMetrics)
+        {
+            cout << "  " << m.name << " (line " << m.line << "): " << m.cyclomaticComplexity << " / "
+                 << m.maxNestingDepth << " / " << m.statementCount << " / " << m.fanIn << " / " << m.fanOut << "\n";
+        }
+    }
+
+    if (layouts && !result.structLayouts.empty())
+    {
+        cout << "\nSTRUCT LAYOUTS (size / align / padding / reordered size):\n";
+        cout << string(70, '-') << "\n";
+        for (const auto &l : result.structLayouts)
+        {
+            cout << "  " << l.name << " (line " << l.line << "): " << l.size << " / " << l.align << " / "
+                 << l.padding << " / " << l.optimalSize;
+            for (const string &m : l.straddling)
+                cout << ", '" << m << "' straddles a cache line";
             cout << "\n";
         }
     }
 
+    if (!result.ruleTimings.empty())
+    {
+        vector<RuleTiming> slowest = result.ruleTimings;
+        sort(slowest.begin(), slowest.end(), [](const RuleTiming &a, const RuleTiming &b)
+             { return a.milliseconds > b.milliseconds; });
+
+        cout << "\nRULE TIMINGS (ms / calls):\n";
+        cout << string(70, '-') << "\n";
+        for (const auto &t : slowest)
+            cout << "  " << t.rule << ": " << t.milliseconds << " / " << t.calls << "\n";
+    }
+
     cout << string(70, '=') << "\n";
-    if (result.totalErrors == 0) {
+    if (result.baselined > 0)
+        cout << "(" << result.baselined << " known issue(s) hidden by the baseline)\n";
+    if (result.totalErrors == 0)
         cout << "SUCCESS: No errors detected!\n";
-    } else {
+    else
         cout << "TOTAL ERRORS: " << result.totalErrors << "\n";
+}
+
+static void printCallGraph(const CallGraphReport &graph)
+{
+    if (graph.cycles.empty() && graph.unreachable.empty())
+        return;
+    cout << "\n" << string(70, '=') << "\n  CALL GRAPH\n" << string(70, '=') << "\n";
+
+    if (!graph.cycles.empty())
+    {
+        cout << "\nRECURSION CYCLES (" << graph.cycles.size() << "):\n";
+        cout << string(70, '-') << "\n";
+        for (const auto &cycle : graph.cycles)
+        {
+            cout << " ";
+            for (const SymbolRef &f : cycle)
+                cout << " " << f.name << " (" << f.file << ":" << f.line << ")";
+            cout << "\n";
+        }
+    }
+
+    if (!graph.unreachable.empty())
+    {
+        cout << "\nUNREACHABLE FROM main (" << graph.unreachable.size() << "):\n";
+        cout << string(70, '-') << "\n";
+        for (const SymbolRef &f : graph.unreachable)
+            cout << "  " << f.name << " (" << f.file << ":" << f.line << ")\n";
+    }
+    cout << string(70, '=') << "\n";
+}
+
+static void printUnused(const vector<SymbolRef> &unused)
+{
+    if (unused.empty())
+        return;
+    cout << "\n" << string(70, '=') << "\n  UNUSED SYMBOLS (" << unused.size() << ")\n" << string(70, '=') << "\n";
+    for (const SymbolRef &s : unused)
+        cout << "  " << s.name << " (" << s.file << ":" << s.line << ") is never referenced\n";
+    cout << string(70, '=') << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = false, timings = false, layouts = false;
+    AnalysisProfile profile = AnalysisProfile::Full;
+    TargetABI target = TargetABI::SysV_x86_64;
+    string baselinePath, writeBaselinePath;
+    vector<pair<string, bool>> ruleSwitches;
+    vector<string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--json")
+            json = true;
+        else if (arg == "--timings")
+            timings = true;
+        else if (arg == "--layout")
+            layouts = true;
+        else if (arg == "--target=x86_64")
+            target = TargetABI::SysV_x86_64;
+        else if (arg == "--target=i386")
+            target = TargetABI::SysV_i386;
+        else if (arg == "--target=win64")
+            target = TargetABI::Win64;
+        else if (arg == "--profile=syntax")
+            profile = AnalysisProfile::SyntaxOnly;
+        else if (arg == "--profile=full")
+            profile = AnalysisProfile::Full;
+        else if (arg.rfind("--baseline=", 0) == 0)
+            baselinePath = arg.substr(11);
+        else if (arg.rfind("--write-baseline=", 0) == 0)
+            writeBaselinePath = arg.substr(17);
+        else if (arg.rfind("--enable-rule=", 0) == 0)
+            ruleSwitches.push_back({arg.substr(14), true});
+        else if (arg.rfind("--disable-rule=", 0) == 0)
+            ruleSwitches.push_back({arg.substr(15), false});
+        else
+            files.push_back(arg);
+    }
+
+    if (files.empty())
+    {
+        cerr << "Usage: " << argv[0] << " [--json] [--timings] [--layout] [--profile=full|syntax]\n"
+             << "       [--target=x86_64|i386|win64] [--enable-rule=NAME] [--disable-rule=NAME]\n"
+             << "       [--baseline=FILE] [--write-baseline=FILE] <file.c>...\n";
+        return 2;
+    }
+
+    CErrorDetectorEngine engine;
+    engine.setRuleProfiling(timings);
+    engine.setProfile(profile);
+    engine.setTargetABI(target);
+    for (const auto &rule : ruleSwitches)
+        if (!engine.setRuleEnabled(rule.first, rule.second))
+        {
+            cerr << "Unknown rule '" << rule.first << "'\n";
+            return 2;
+        }
+    if (!baselinePath.empty() && !engine.loadBaseline(baselinePath))
+    {
+        cerr << "Could not read baseline '" << baselinePath << "'\n";
+        return 2;
+    }
+    engine.recordBaseline(!writeBaselinePath.empty());
+    vector<AnalysisResult> analyses = engine.analyzeFiles(files);
+
+    vector<pair<string, AnalysisResult>> results;
+    int totalErrors = 0;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        results.push_back({files[i], analyses[i]});
+        totalErrors += analyses[i].totalErrors;
     }
-    cout << string(70, '=') << "\n\n";
 
-    return 0;
-}*/
+    // A lone file's exported functions are there for other files to use
+    vector<SymbolRef> unused;
+    if (files.size() > 1 && profile == AnalysisProfile::Full)
+        unused = engine.getUnusedSymbols();
+
+    if (json)
+        printJson(results, engine.getCallGraph(), unused);
+    else
+    {
+        for (const auto &r : results)
+            printText(r.first, r.second, layouts);
+        printCallGraph(engine.getCallGraph());
+        printUnused(unused);
+    }
+
+    if (!writeBaselinePath.empty() && !engine.writeBaseline(writeBaselinePath))
+    {
+        cerr << "Could not write baseline '" << writeBaselinePath << "'\n";
+        return 2;
+    }
+
+    return totalErrors == 0 ? 0 : 1;
+}
+
+#endif // SCERSE_CLI
@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+// Read-only memory maps of whole files, POSIX and Win32.
+// The platform headers stay in mapped_file.cpp: <windows.h> declares names
+// such as TokenType that collide with the analyzer's own types.
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+private:
+    const char *ptr = nullptr;
+    size_t length = 0;
+    void *file = nullptr;    // Win32 file HANDLE
+    void *mapping = nullptr; // Win32 mapping HANDLE
+    int fd = -1;             // POSIX descriptor
+
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path);
+    void close();
+
+    const char *data() const { return ptr; }
+    size_t size() const { return length; }
+};
+
+#endif
@@ -0,0 +1,436 @@
+#ifndef SOURCE_ENCODING_H
+#define SOURCE_ENCODING_H
+
+// Encoding detection and transcoding to UTF-8 for source files, shared by
+// the analyzer (c_error_detector.cpp) and the editor's file loader.
+// Standard C++ only, header-only.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOURCE_ENCODING_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+enum class SourceEncoding
+{
+    UTF8,
+    UTF16LE,
+    UTF16BE,
+    UTF32LE,
+    UTF32BE,
+    Latin1, // bytes that are not UTF-8
+    Binary  // not text at all
+};
+
+inline const char *encodingName(SourceEncoding encoding)
+{
+    switch (encoding)
+    {
+    case SourceEncoding::UTF8:
+        return "UTF-8";
+    case SourceEncoding::UTF16LE:
+        return "UTF-16LE";
+    case SourceEncoding::UTF16BE:
+        return "UTF-16BE";
+    case SourceEncoding::UTF32LE:
+        return "UTF-32LE";
+    case SourceEncoding::UTF32BE:
+        return "UTF-32BE";
+    case SourceEncoding::Latin1:
+        return "Latin-1";
+    case SourceEncoding::Binary:
+        break;
+    }
+    return "binary";
+}
+
+#ifdef SOURCE_ENCODING_SSE2
+inline unsigned lowestSetBit(unsigned mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Sequence length of a UTF-8 lead byte and the allowed range of the byte
+// after it, per the Unicode table of well-formed sequences; false if c
+// cannot start a multi-byte sequence
+inline bool utf8Lead(unsigned char c, size_t &length, unsigned char &low, unsigned char &high)
+{
+    low = 0x80, high = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF)
+        length = 2;
+    else if (c == 0xE0)
+        length = 3, low = 0xA0;
+    else if (c == 0xED)
+        length = 3, high = 0x9F;
+    else if (c >= 0xE1 && c <= 0xEF)
+        length = 3;
+    else if (c == 0xF0)
+        length = 4, low = 0x90;
+    else if (c >= 0xF1 && c <= 0xF3)
+        length = 4;
+    else if (c == 0xF4)
+        length = 4, high = 0x8F;
+    else
+        return false;
+    return true;
+}
+
+// Length of the longest prefix made of complete, well-formed UTF-8
+// sequences; overlong forms, surrogates and code points past U+10FFFF are
+// ill-formed. ASCII runs, nearly all of a C file, are skipped 16 bytes at a
+// time with SSE2 (8 at a time elsewhere).
+inline size_t utf8ValidPrefix(const char *data, size_t size)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    size_t i = 0;
+    while (i < size)
+    {
+#ifdef SOURCE_ENCODING_SSE2
+        while (i + 16 <= size)
+        {
+            unsigned high = (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s + i)));
+            if (high)
+            {
+                i += lowestSetBit(high);
+                break;
+            }
+            i += 16;
+        }
+#else
+        while (i + 8 <= size)
+        {
+            uint64_t word;
+            memcpy(&word, s + i, 8);
+            if (word & 0x8080808080808080ull)
+                break;
+            i += 8;
+        }
+#endif
+        if (i >= size)
+            break;
+        if (s[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        size_t length;
+        unsigned char low, high;
+        if (!utf8Lead(s[i], length, low, high) || size - i < length || s[i + 1] < low || s[i + 1] > high)
+            return i;
+        for (size_t k = 2; k < length; k++)
+            if ((s[i + k] & 0xC0) != 0x80)
+                return i;
+        i += length;
+    }
+    return i;
+}
+
+// Whether bytes that utf8ValidPrefix() stopped at are the start of a
+// sequence cut off by the end of the buffer rather than an ill-formed one
+inline bool utf8Truncated(const char *data, size_t size)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    size_t length;
+    unsigned char low, high;
+    if (size == 0 || !utf8Lead(s[0], length, low, high) || size >= length)
+        return false;
+    if (size >= 2 && (s[1] < low || s[1] > high))
+        return false;
+    return size < 3 || (s[2] & 0xC0) == 0x80;
+}
+
+inline void appendUTF8(uint32_t codePoint, std::string &out)
+{
+    if (codePoint < 0x80)
+    {
+        out += (char)codePoint;
+    }
+    else if (codePoint < 0x800)
+    {
+        out += (char)(0xC0 | (codePoint >> 6));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        out += (char)(0xE0 | (codePoint >> 12));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | (codePoint >> 18));
+        out += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codePoint & 0x3F));
+    }
+}
+
+inline void appendLatin1(const char *data, size_t size, std::string &out)
+{
+    out.reserve(out.size() + size + size / 8);
+    for (size_t i = 0; i < size; i++)
+        appendUTF8((unsigned char)data[i], out);
+}
+
+// How many bytes the encoding is judged by
+constexpr size_t SNIFF_BYTES = 8192;
+
+// The encoding of a file from its first bytes. A byte order mark decides,
+// and bomBytes is set to its length. Otherwise NUL bytes mean binary data,
+// unless they fill every other byte the way ASCII text in UTF-16 does.
+// Everything else is reported as UTF-8; whether it really is shows while
+// decoding.
+inline SourceEncoding sniffEncoding(const char *data, size_t size, size_t &bomBytes)
+{
+    const unsigned char *s = (const unsigned char *)data;
+    bomBytes = 0;
+    if (size >= 4 && s[0] == 0xFF && s[1] == 0xFE && s[2] == 0 && s[3] == 0)
+    {
+        bomBytes = 4;
+        return SourceEncoding::UTF32LE;
+    }
+    if (size >= 4 && s[0] == 0 && s[1] == 0 && s[2] == 0xFE && s[3] == 0xFF)
+    {
+        bomBytes = 4;
+        return SourceEncoding::UTF32BE;
+    }
+    if (size >= 3 && s[0] == 0xEF && s[1] == 0xBB && s[2] == 0xBF)
+    {
+        bomBytes = 3;
+        return SourceEncoding::UTF8;
+    }
+    if (size >= 2 && s[0] == 0xFF && s[1] == 0xFE)
+    {
+        bomBytes = 2;
+        return SourceEncoding::UTF16LE;
+    }
+    if (size >= 2 && s[0] == 0xFE && s[1] == 0xFF)
+    {
+        bomBytes = 2;
+        return SourceEncoding::UTF16BE;
+    }
+
+    size_t sniffed = size < SNIFF_BYTES ? size : SNIFF_BYTES;
+    if (sniffed == 0 || !memchr(data, 0, sniffed))
+        return SourceEncoding::UTF8;
+
+    size_t evenZeros = 0, oddZeros = 0;
+    sniffed &= ~(size_t)1;
+    for (size_t i = 0; i < sniffed; i += 2)
+    {
+        evenZeros += s[i] == 0;
+        oddZeros += s[i + 1] == 0;
+    }
+    size_t units = sniffed / 2;
+    if (oddZeros * 2 > units && evenZeros * 4 < oddZeros)
+        return SourceEncoding::UTF16LE;
+    if (evenZeros * 2 > units && oddZeros * 4 < evenZeros)
+        return SourceEncoding::UTF16BE;
+    return SourceEncoding::Binary;
+}
+
+// Turns a file into UTF-8 a buffer at a time. The first call to decode()
+// sniffs the encoding; sequences split between buffers are carried over.
+// A file sniffed as UTF-8 switches to Latin-1 at its first ill-formed byte.
+// Unpaired surrogates and code points past U+10FFFF become U+FFFD.
+class SourceDecoder
+{
+private:
+    SourceEncoding detected = SourceEncoding::UTF8;
+    bool sniffed = false;
+    std::string carry; // start of a sequence the last buffer cut off
+
+    static uint32_t unit16(const unsigned char *p, bool little) { return little ? p[0] | p[1] << 8 : p[0] << 8 | p[1]; }
+
+    static uint32_t unit32(const unsigned char *p, bool little)
+    {
+        return little ? (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24
+                      : (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+    }
+
+    void decodeUTF8(const char *data, size_t size, std::string &out)
+    {
+        size_t valid = utf8ValidPrefix(data, size);
+        out.append(data, valid);
+        if (valid == size)
+            return;
+        if (utf8Truncated(data + valid, size - valid))
+        {
+            carry.assign(data + valid, size - valid);
+            return;
+        }
+        detected = SourceEncoding::Latin1;
+        appendLatin1(data + valid, size - valid, out);
+    }
+
+    void decodeUTF16(const char *data, size_t size, std::string &out)
+    {
+        const unsigned char *s = (const unsigned char *)data;
+        bool little = detected == SourceEncoding::UTF16LE;
+        out.reserve(out.size() + size / 2);
+        size_t i = 0;
+        for (; i + 2 <= size; i += 2)
+        {
+            uint32_t u = unit16(s + i, little);
+            if (u < 0xD800 || u > 0xDFFF)
+            {
+                appendUTF8(u, out);
+                continue;
+            }
+            if (u <= 0xDBFF && i + 4 > size)
+                break; // the low surrogate is in the next buffer
+            uint32_t low = u <= 0xDBFF ? unit16(s + i + 2, little) : 0;
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                appendUTF8(0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00), out);
+                i += 2;
+            }
+            else
+            {
+                appendUTF8(0xFFFD, out);
+            }
+        }
+        carry.assign(data + i, size - i);
+    }
+
+    void decodeUTF32(const char *data, size_t size, std::string &out)
+    {
+        const unsigned char *s = (const unsigned char *)data;
+        bool little = detected == SourceEncoding::UTF32LE;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            uint32_t u = unit32(s + i, little);
+            appendUTF8(u > 0x10FFFF || (u >= 0xD800 && u <= 0xDFFF) ? 0xFFFD : u, out);
+        }
+        carry.assign(data + i, size - i);
+    }
+
+    void sniff(std::string &out)
+    {
+        std::string head;
+        head.swap(carry);
+        size_t bom;
+        sniffed = true;
+        detected = sniffEncoding(head.data(), head.size(), bom);
+        convert(head.data() + bom, head.size() - bom, out);
+    }
+
+    void convert(const char *data, size_t size, std::string &out)
+    {
+        std::string joined;
+        if (!carry.empty())
+        {
+            joined = carry;
+            joined.append(data, size);
+            carry.clear();
+            data = joined.data();
+            size = joined.size();
+        }
+
+        switch (detected)
+        {
+        case SourceEncoding::UTF8:
+            decodeUTF8(data, size, out);
+            break;
+        case SourceEncoding::Latin1:
+            appendLatin1(data, size, out);
+            break;
+        case SourceEncoding::UTF16LE:
+        case SourceEncoding::UTF16BE:
+            decodeUTF16(data, size, out);
+            break;
+        case SourceEncoding::UTF32LE:
+        case SourceEncoding::UTF32BE:
+            decodeUTF32(data, size, out);
+            break;
+        case SourceEncoding::Binary:
+            break;
+        }
+    }
+
+public:
+    SourceEncoding encoding() const { return detected; }
+
+    // Appends the UTF-8 of the next bytes to out; nothing once binary
+    void decode(const char *data, size_t size, std::string &out)
+    {
+        if (sniffed)
+        {
+            convert(data, size, out);
+            return;
+        }
+        carry.append(data, size);
+        if (carry.size() >= 4) // enough for any byte order mark
+            sniff(out);
+    }
+
+    // At the end of the file: a sequence still cut off is ill-formed
+    void finish(std::string &out)
+    {
+        if (!sniffed)
+            sniff(out);
+        if (carry.empty())
+            return;
+        if (detected == SourceEncoding::UTF8)
+        {
+            detected = SourceEncoding::Latin1;
+            appendLatin1(carry.data(), carry.size(), out);
+        }
+        else
+        {
+            appendUTF8(0xFFFD, out);
+        }
+        carry.clear();
+    }
+};
+
+// A whole file as UTF-8 without its byte order mark; false for binary data.
+// Well-formed UTF-8 is not copied: text views bytes. Anything else is
+// transcoded into storage by a SourceDecoder, so the command line reads a
+// file exactly as the editor's chunked loader does.
+inline bool decodeSource(std::string_view bytes, std::string &storage, std::string_view &text,
+                         SourceEncoding &encoding)
+{
+    size_t bom;
+    std::string_view raw = bytes;
+    encoding = sniffEncoding(bytes.data(), bytes.size(), bom);
+    bytes.remove_prefix(bom);
+    storage.clear();
+
+    if (encoding == SourceEncoding::Binary)
+    {
+        text = std::string_view();
+        return false;
+    }
+    if (encoding == SourceEncoding::UTF8 && utf8ValidPrefix(bytes.data(), bytes.size()) == bytes.size())
+    {
+        text = bytes;
+        return true;
+    }
+
+    SourceDecoder decoder;
+    decoder.decode(raw.data(), raw.size(), storage);
+    decoder.finish(storage);
+    encoding = decoder.encoding();
+    text = storage;
+    return true;
+}
+
+#endif // SOURCE_ENCODING_H